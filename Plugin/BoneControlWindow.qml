@@ -13,6 +13,9 @@ Window {
 
     property alias manipulator: manipulator
 
+    // Экспорт захватывает сцену: всё, что в нее пишет, отключено
+    property bool sceneLocked: false
+
     flags: Qt.Window | Qt.WindowSystemMenuHint | Qt.WindowTitleHint |
            Qt.WindowMinMaxButtonsHint | Qt.WindowCloseButtonHint
 
@@ -23,6 +26,7 @@ Window {
     ScrollView {
         anchors.fill: parent
         anchors.margins: 15
+        enabled: !root.sceneLocked
 
         Column {
             spacing: 15
@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick3D
+import MotionPlugin 1.0
 
 QtObject {
     id: root
@@ -25,6 +26,12 @@ QtObject {
     // Кэш реальных узлов модели для быстрого доступа
     property var modelNodes: []
 
+    // Индекс для выбора костей кликом во viewport и поиска по имени
+    property BonePicker picker: BonePicker {}
+
+    // Перенос поз между скелетами (MotionRetargeter), задается извне
+    property var retargeter: null
+
     // Сигналы
     signal boneSelected(var boneIndex, var boneData)
     signal boneTransformChanged(var boneIndex, var transform)
@@ -36,6 +43,7 @@ QtObject {
             updateBonesList()
             cacheModelNodes()
             saveOriginalTransforms()
+            picker.setBones(modelNodes, bonesList)
         } else {
             clearBonesList()
         }
@@ -46,6 +54,7 @@ QtObject {
         if (manipulationEnabled) {
             cacheModelNodes()
             saveOriginalTransforms()
+            picker.setBones(modelNodes, bonesList)
         }
     }
 
@@ -158,6 +167,7 @@ QtObject {
         boneTransforms = {}
         originalTransforms = {}
         modelNodes = []
+        picker.clear()
         selectedBoneIndex = null
         selectedBoneData = null
         bonesListUpdated()
@@ -168,15 +178,29 @@ QtObject {
 
         selectedBoneIndex = boneIndex
 
-        if (boneIndex !== null && boneIndex < bonesList.length) {
-            selectedBoneData = bonesList[boneIndex]
-        } else {
-            selectedBoneData = null
-        }
+        // boneIndex - индекс узла в modelNodes, позиция в bonesList берется из индекса
+        var position = boneIndex !== null ? picker.listPosition(boneIndex) : -1
+        selectedBoneData = position >= 0 ? bonesList[position] : null
 
         boneSelected(selectedBoneIndex, selectedBoneData)
     }
 
+    // Выбрать кость лучом из viewport (координаты сцены)
+    function pickBone(rayOrigin, rayDirection) {
+        if (!manipulationEnabled) return -1
+
+        var boneIndex = picker.pick(rayOrigin, rayDirection)
+        if (boneIndex >= 0) {
+            selectBone(boneIndex)
+        }
+        return boneIndex
+    }
+
+    // Найти индекс кости по имени (-1 если не найдена)
+    function findBoneByName(name) {
+        return picker.boneIndexForName(name)
+    }
+
     function getBoneTransform(boneIndex) {
         return boneTransforms[boneIndex] || {
             position: { x: 0, y: 0, z: 0 },
@@ -263,6 +287,9 @@ QtObject {
                 targetNode.scale = newScale
             }
 
+            // Позиции костей изменились - индекс пересчитается при следующем выборе
+            picker.markDirty()
+
             console.log("Applied transform to node", boneIndex, "successfully")
         } catch (e) {
             console.log("Error applying transform to node", boneIndex, ":", e)
@@ -325,6 +352,11 @@ QtObject {
             bones: {}
         }
 
+        // Скелет позы - чтобы ее можно было применить к другому персонажу
+        if (retargeter) {
+            pose.skeleton = retargeter.skeletonProfile(bonesList, originalTransforms)
+        }
+
         for (var key in boneTransforms) {
             pose.bones[key] = boneTransforms[key]
         }
@@ -337,10 +369,26 @@ QtObject {
             var pose = JSON.parse(poseJson)
 
             if (pose.bones) {
-                for (var key in pose.bones) {
+                var bones = pose.bones
+
+                // Поза другого скелета: индексы костей переназначаются по карте
+                // (для того же скелета retargetPose возвращает позу как есть)
+                if (pose.skeleton && retargeter) {
+                    bones = retargeter.retargetPose(pose.skeleton,
+                                                    retargeter.skeletonProfile(bonesList, originalTransforms),
+                                                    pose.bones)
+
+                    if (Object.keys(bones).length === 0 && Object.keys(pose.bones).length > 0) {
+                        console.log("Error importing pose: no bones of the pose skeleton map to the loaded model")
+                        return false
+                    }
+                }
+
+                // Ключи - индексы modelNodes, а не позиции в bonesList
+                for (var key in bones) {
                     var boneIndex = parseInt(key)
-                    if (boneIndex >= 0 && boneIndex < bonesList.length) {
-                        setBoneTransform(boneIndex, pose.bones[key])
+                    if (boneIndex >= 0 && boneIndex < modelNodes.length) {
+                        setBoneTransform(boneIndex, bones[key])
                     }
                 }
                 console.log("Pose imported successfully")
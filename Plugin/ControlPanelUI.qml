@@ -18,6 +18,12 @@ Rectangle {
     property var boneManipulator
     property var keyframeManager
     property var physicsWindow  // Добавлена ссылка на PhysicsWindow
+    property var crowdWindow
+    property var poseStreamWindow
+    property var retargetWindow
+
+    // Экспорт захватывает сцену: кнопки, меняющие ее, отключены
+    property bool sceneLocked: false
 
     color: "#80000000"
     height: 50
@@ -32,7 +38,11 @@ Rectangle {
     signal toggleSkeletonRequested()
     signal toggleBoneManipulationRequested()
     signal togglePhysicsRequested()
+    signal toggleCrowdRequested()
+    signal togglePoseStreamRequested()
+    signal toggleRetargetRequested()
     signal exportKeyframesRequested()
+    signal importMotionRequested()
     signal exportAnimationRequested()
 
     RowLayout {
@@ -46,6 +56,7 @@ Rectangle {
             id: orbitButton
             text: "Режим Orbit"
             Layout.preferredWidth: 120
+            enabled: !sceneLocked
             background: Rectangle {
                 color: cameraHelper.orbitControllerEnabled ? "#007acc" : "#444444"
                 radius: 4
@@ -65,6 +76,7 @@ Rectangle {
             id: wasdButton
             text: "Режим WASD"
             Layout.preferredWidth: 120
+            enabled: !sceneLocked
             background: Rectangle {
                 color: !cameraHelper.orbitControllerEnabled ? "#007acc" : "#444444"
                 radius: 4
@@ -83,6 +95,7 @@ Rectangle {
         Button {
             text: "Сброс вида"
             Layout.preferredWidth: 120
+            enabled: !sceneLocked
             onClicked: resetViewRequested()
             ToolTip.visible: hovered
             ToolTip.text: "Сбросить положение камеры"
@@ -93,6 +106,7 @@ Rectangle {
             property bool gridState: gridManager.gridEnabled
             text: gridState ? "Скрыть сетку" : "Показать сетку"
             Layout.preferredWidth: 120
+            enabled: !sceneLocked
             onClicked: {
                 toggleGridRequested()
                 gridState = gridManager.gridEnabled
@@ -104,6 +118,7 @@ Rectangle {
         Button {
             text: "Загрузить модель"
             Layout.preferredWidth: 120
+            enabled: !sceneLocked
             onClicked: importModelRequested()
             ToolTip.visible: hovered
             ToolTip.text: "Загрузить 3D модель (glTF, GLB)"
@@ -154,6 +169,69 @@ Rectangle {
             ToolTip.text: "Открыть окно симуляции физики"
         }
 
+        Button {
+            text: "👥 Crowd"
+            Layout.preferredWidth: 120
+            background: Rectangle {
+                color: (crowdWindow && crowdWindow.crowdEnabled) ? "#007acc" : "#444444"
+                radius: 4
+            }
+            contentItem: Text {
+                text: parent.text
+                color: "white"
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+            onClicked: toggleCrowdRequested()
+            ToolTip.visible: hovered
+            ToolTip.text: "Открыть окно предпросмотра толпы"
+        }
+
+        Button {
+            text: "📡 Live"
+            Layout.preferredWidth: 100
+            background: Rectangle {
+                color: (poseStreamWindow && poseStreamWindow.stream.listening) ? "#007acc" : "#444444"
+                radius: 4
+            }
+            contentItem: Text {
+                text: parent.text
+                color: "white"
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+            onClicked: togglePoseStreamRequested()
+            ToolTip.visible: hovered
+            ToolTip.text: "Живой поток поз по UDP или локальному сокету"
+        }
+
+        Button {
+            text: "🔁 Retarget"
+            Layout.preferredWidth: 110
+            background: Rectangle {
+                color: (retargetWindow && retargetWindow.visible) ? "#007acc" : "#444444"
+                radius: 4
+            }
+            contentItem: Text {
+                text: parent.text
+                color: "white"
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+            onClicked: toggleRetargetRequested()
+            ToolTip.visible: hovered
+            ToolTip.text: "Перенос анимации ключевых кадров на скелет загруженной модели"
+        }
+
+        Button {
+            text: "📥 Import Motion"
+            Layout.preferredWidth: 140
+            enabled: boneManipulator && boneManipulator.manipulationEnabled && !sceneLocked
+            onClicked: importMotionRequested()
+            ToolTip.visible: hovered
+            ToolTip.text: "Импорт анимации из BVH или glTF в ключевые кадры"
+        }
+
         Button {
             text: "💾 Export Keyframes"
             Layout.preferredWidth: 140
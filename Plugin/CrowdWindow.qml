@@ -0,0 +1,212 @@
+import QtQuick
+import QtQuick.Window
+import QtQuick.Controls
+import QtQuick.Layouts
+import MotionPlugin 1.0
+
+Window {
+    id: root
+    width: 420
+    height: 520
+    visible: false
+    title: "Crowd Preview"
+    color: "#2a2a2a"
+
+    property alias instancing: crowd
+    property bool crowdEnabled: enableSwitch.checked
+    property var keyframeManager: null
+
+    // Экспорт захватывает сцену: всё, что в нее пишет, отключено
+    property bool sceneLocked: false
+
+    flags: Qt.Window | Qt.WindowSystemMenuHint | Qt.WindowTitleHint |
+           Qt.WindowMinMaxButtonsHint | Qt.WindowCloseButtonHint
+
+    CrowdInstancing {
+        id: crowd
+        count: countSlider.value
+        spacing: spacingSlider.value
+        maxTimeOffset: offsetSlider.value
+    }
+
+    // Воспроизведение: время толпы идет независимо от таймлайна
+    FrameAnimation {
+        running: root.crowdEnabled && playSwitch.checked && !root.sceneLocked
+        onTriggered: {
+            var length = Math.max(1, crowd.trackLength)
+            crowd.time = (crowd.time + frameTime * fpsSlider.value) % length
+        }
+    }
+
+    // Трансформация модели переходит в экземпляры, узел закрепляется в нуле
+    onCrowdEnabledChanged: {
+        if (keyframeManager) {
+            keyframeManager.pinModelTransform(crowdEnabled)
+        }
+        if (crowdEnabled) {
+            refreshTrack()
+        }
+    }
+
+    ScrollView {
+        anchors.fill: parent
+        anchors.margins: 15
+        enabled: !root.sceneLocked
+
+        Column {
+            spacing: 15
+            width: root.width - 30
+
+            Text {
+                text: "👥 Crowd Preview"
+                color: "white"
+                font.bold: true
+                font.pixelSize: 18
+            }
+
+            Rectangle {
+                width: parent.width
+                height: settingsColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: settingsColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 8
+
+                    Switch {
+                        id: enableSwitch
+                        text: "Crowd mode"
+                        checked: false
+                        palette.windowText: "white"
+                    }
+
+                    Text {
+                        text: "Instances: " + countSlider.value.toFixed(0)
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Slider {
+                        id: countSlider
+                        width: parent.width
+                        from: 1
+                        to: 5000
+                        stepSize: 1
+                        value: 100
+                        focusPolicy: Qt.NoFocus
+                    }
+
+                    Text {
+                        text: "Spacing: " + spacingSlider.value.toFixed(0)
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Slider {
+                        id: spacingSlider
+                        width: parent.width
+                        from: 10
+                        to: 1000
+                        value: 150
+                        focusPolicy: Qt.NoFocus
+                    }
+
+                    Text {
+                        text: "Max time offset: " + offsetSlider.value.toFixed(0) + " frames"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Slider {
+                        id: offsetSlider
+                        width: parent.width
+                        from: 0
+                        to: Math.max(1, crowd.trackLength)
+                        value: 0
+                        focusPolicy: Qt.NoFocus
+                    }
+                }
+            }
+
+            Rectangle {
+                width: parent.width
+                height: playbackColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: playbackColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 8
+
+                    Switch {
+                        id: playSwitch
+                        text: "Play"
+                        checked: true
+                        palette.windowText: "white"
+                    }
+
+                    Text {
+                        text: "Playback: " + fpsSlider.value.toFixed(0) + " fps"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Slider {
+                        id: fpsSlider
+                        width: parent.width
+                        from: 1
+                        to: 60
+                        value: 24
+                        focusPolicy: Qt.NoFocus
+                    }
+
+                    Text {
+                        text: "• Track: " + crowd.trackLength.toFixed(0) + " frames | Time: " + crowd.time.toFixed(1)
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Button {
+                        text: "🔄 Refresh keyframes"
+                        onClicked: refreshTrack()
+                    }
+                }
+            }
+
+            Text {
+                text: "💡 All instances share the current bone pose; each one plays the keyframed model transform with its own offset. While crowd mode is on, the model itself stays at the origin."
+                color: "#cccccc"
+                font.pixelSize: 10
+                wrapMode: Text.WordWrap
+                width: parent.width
+            }
+        }
+    }
+
+    function refreshTrack() {
+        if (keyframeManager) {
+            crowd.setTrack(keyframeManager.getModelTrack())
+        }
+    }
+
+    // Во время экспорта толпа следует за загружаемыми ключевыми кадрами
+    Connections {
+        target: keyframeManager
+        enabled: root.crowdEnabled && !playSwitch.checked
+
+        function onKeyframeLoaded(frame, data) {
+            crowd.time = frame
+        }
+    }
+}
@@ -23,7 +23,7 @@ Window {
     AnimationExporter {
         id: exporter
 
-        onExportCompleted: function(success, message) {
+        onExportCompleted: function(success, message, jobId, state) {
             if (success) {
                 statusText.color = "#4CAF50"
                 statusText.text = "✅ " + message
@@ -32,7 +32,13 @@ Window {
                 statusText.text = "❌ " + message
             }
 
-            messageDialog.title = success ? "Export Successful" : "Export Failed"
+            // Итог задания из очереди показывается в его строке,
+            // диалог только если задание не удалось поставить в очередь
+            if (jobId > 0) {
+                return
+            }
+
+            messageDialog.title = "Export Failed"
             messageDialog.text = message
             messageDialog.open()
         }
@@ -119,6 +125,38 @@ Window {
                         }
                     }
 
+                    // Concurrent encodes
+                    Row {
+                        width: parent.width
+                        spacing: 10
+
+                        Text {
+                            text: "Parallel encodes:"
+                            color: "white"
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 120
+                        }
+
+                        Slider {
+                            id: concurrencySlider
+                            width: 200
+                            from: 1
+                            to: 4
+                            stepSize: 1
+                            snapMode: Slider.SnapAlways
+                            value: exporter.maxConcurrentEncodes
+                            onValueChanged: exporter.maxConcurrentEncodes = value
+                        }
+
+                        Text {
+                            text: concurrencySlider.value.toFixed(0)
+                            color: "white"
+                            width: 50
+                            font.pixelSize: 12
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
                     // Resolution Setting
                     Row {
                         width: parent.width
@@ -353,6 +391,121 @@ Window {
                         color: "#4CAF50"
                         font.pixelSize: 12
                     }
+
+                    Text {
+                        visible: exporter.viewportBusy
+                        text: "🔒 The main viewport is busy: it shows the frames being captured and ignores input. Camera, pose and selection come back when capture ends."
+                        color: "#FF9800"
+                        font.pixelSize: 12
+                        wrapMode: Text.WordWrap
+                        width: parent.width
+                    }
+                }
+            }
+
+            // Export Queue
+            Rectangle {
+                width: parent.width
+                height: queueColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+                visible: exporter.jobs.length > 0
+
+                Column {
+                    id: queueColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 15
+                    spacing: 8
+
+                    Text {
+                        text: "📋 Export Queue"
+                        color: "lightblue"
+                        font.bold: true
+                        font.pixelSize: 14
+                    }
+
+                    Repeater {
+                        model: exporter.jobs
+
+                        Rectangle {
+                            width: queueColumn.width
+                            height: jobColumn.height + 10
+                            color: "#2a2a2a"
+                            radius: 3
+
+                            property bool done: modelData.state === "finished" ||
+                                                modelData.state === "failed" ||
+                                                modelData.state === "cancelled"
+
+                            Column {
+                                id: jobColumn
+                                anchors.left: parent.left
+                                anchors.right: cancelJobButton.left
+                                anchors.margins: 5
+                                anchors.verticalCenter: parent.verticalCenter
+                                spacing: 4
+
+                                Text {
+                                    text: "#" + modelData.id + " " + modelData.state + " — " +
+                                          modelData.capturedFrames + " / " + modelData.totalFrames +
+                                          " frames, " + modelData.width + "x" + modelData.height
+                                    color: modelData.state === "finished" ? "#4CAF50"
+                                         : modelData.state === "failed" ? "#f44336"
+                                         : modelData.state === "cancelled" ? "#888888" : "white"
+                                    font.pixelSize: 12
+                                }
+
+                                ProgressBar {
+                                    width: parent.width
+                                    height: 6
+                                    from: 0
+                                    to: 1
+                                    value: modelData.progress
+                                    visible: !parent.parent.done
+                                }
+
+                                Text {
+                                    text: modelData.outputPath
+                                    color: "#aaaaaa"
+                                    font.pixelSize: 10
+                                    elide: Text.ElideMiddle
+                                    width: parent.width
+                                }
+
+                                // Итог задания: путь к файлу или причина ошибки
+                                Text {
+                                    visible: parent.parent.done && modelData.message.length > 0
+                                    text: (modelData.state === "finished" ? "✅ " :
+                                           modelData.state === "failed" ? "❌ " : "") + modelData.message
+                                    color: modelData.state === "failed" ? "#f44336" : "#cccccc"
+                                    font.pixelSize: 10
+                                    wrapMode: Text.WordWrap
+                                    maximumLineCount: 3
+                                    elide: Text.ElideRight
+                                    width: parent.width
+                                }
+                            }
+
+                            Button {
+                                id: cancelJobButton
+                                text: "✖"
+                                width: 30
+                                height: 30
+                                anchors.right: parent.right
+                                anchors.rightMargin: 5
+                                anchors.verticalCenter: parent.verticalCenter
+                                enabled: !parent.done
+                                onClicked: exporter.cancelJob(modelData.id)
+                            }
+                        }
+                    }
+
+                    Button {
+                        text: "🧹 Clear finished"
+                        onClicked: exporter.clearFinishedJobs()
+                    }
                 }
             }
 
@@ -402,43 +555,57 @@ Window {
 
                 Button {
                     id: exportButton
-                    text: exporter.isExporting ? "⏹️ Stop Export" : "🎬 Start Export"
+                    text: "➕ Add to Queue"
                     width: 150
                     height: 40
-                    enabled: !exporter.isExporting || exporter.isExporting
 
-                    onClicked: {
-                        if (exporter.isExporting) {
-                            exporter.stopExport()
-                        } else {
-                            startExport()
-                        }
+                    onClicked: startExport()
+
+                    background: Rectangle {
+                        color: exportButton.pressed ? "#388e3c" : "#4CAF50"
+                        border.color: "#777777"
+                        radius: 5
+                    }
+
+                    contentItem: Text {
+                        text: exportButton.text
+                        color: "white"
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                        font.bold: true
                     }
+                }
+
+                Button {
+                    id: cancelAllButton
+                    text: "⏹️ Cancel All"
+                    width: 120
+                    height: 40
+                    enabled: exporter.isExporting
+                    onClicked: exporter.stopExport()
 
                     background: Rectangle {
                         color: {
-                            if (!exportButton.enabled) return "#333333"
-                            if (exporter.isExporting) return exportButton.pressed ? "#c62828" : "#f44336"
-                            return exportButton.pressed ? "#388e3c" : "#4CAF50"
+                            if (!cancelAllButton.enabled) return "#333333"
+                            return cancelAllButton.pressed ? "#c62828" : "#f44336"
                         }
                         border.color: "#777777"
                         radius: 5
                     }
 
                     contentItem: Text {
-                        text: exportButton.text
-                        color: exportButton.enabled ? "white" : "#888888"
+                        text: cancelAllButton.text
+                        color: cancelAllButton.enabled ? "white" : "#888888"
                         horizontalAlignment: Text.AlignHCenter
                         verticalAlignment: Text.AlignVCenter
-                        font.bold: true
                     }
                 }
 
+                // Экспорт продолжается в фоне, окно можно закрыть
                 Button {
                     text: "❌ Close"
                     width: 100
                     height: 40
-                    enabled: !exporter.isExporting
                     onClicked: root.visible = false
 
                     background: Rectangle {
@@ -502,6 +669,14 @@ Window {
                         width: parent.width
                     }
 
+                    Text {
+                        text: "• Exports are queued: keyframes are captured one job at a time, encoding runs in the background"
+                        color: "#cccccc"
+                        font.pixelSize: 10
+                        wrapMode: Text.WordWrap
+                        width: parent.width
+                    }
+
                     Text {
                         text: "• Export time depends on number of keyframes and resolution"
                         color: "#cccccc"
@@ -605,9 +780,9 @@ Window {
         var resolution = resolutions[resolutionComboBox.currentIndex] || {width: 1920, height: 1080}
 
         statusText.color = "white"
-        statusText.text = "🔄 Starting export..."
+        statusText.text = "🔄 Adding export to queue..."
 
-        exporter.startExport(keyframeManager, view3d, resolution.width, resolution.height)
+        exporter.enqueueExport(keyframeManager, view3d, resolution.width, resolution.height)
     }
 
     function getAnimationDuration() {
@@ -19,19 +19,61 @@ QtObject {
     // Хранилище ключевых кадров
     property var keyframes: ({})
 
+    // Скелет, к костям которого относятся трансформации в кадрах
+    // (MotionRetargeter.skeletonProfile), null если неизвестен
+    property var skeleton: null
+
+    // Импортированный дубль (MotionImporter). Кости на кадрах
+    // motionTrack.startFrame .. motionTrack.endFrame - 1 берутся из него
+    property var motionTrack: null
+
+    // Режим толпы: трансформация модели уходит в таблицу экземпляров
+    // (CrowdInstancing), а сам узел стоит в нуле, чтобы движение
+    // не применялось дважды. Здесь хранится снятая с узла трансформация
+    property bool modelPinned: false
+    property var pinnedModelTransform: null
+
+    // Экспорт захватывает сцену (AnimationExporter.viewportBusy): сцену
+    // меняет только он через applyKeyframeData, сохранять ее нельзя
+    property bool sceneLocked: false
+
     // Сигналы
     signal keyframeSaved(int frame, var data)
     signal keyframeLoaded(int frame, var data)
     signal keyframeDeleted(int frame)
+    // Перед снимком сцены: источники, которые пишут в узлы костей напрямую
+    // (PoseStream), переносят свою позу в boneManipulator.boneTransforms
+    signal sceneStateRequested()
 
     // Сохранить текущее состояние сцены как ключевой кадр
     function saveKeyframe(frame) {
+        if (sceneLocked) {
+            console.log("Scene is busy with an export, keyframe", frame + 1, "not saved")
+            return null
+        }
+
         console.log("Saving keyframe for frame:", frame + 1)
 
-        var keyframeData = {
+        var keyframeData = captureSceneState()
+        keyframeData.frame = frame
+
+        keyframes[frame] = keyframeData
+
+        console.log("Keyframe saved for frame", frame + 1, "- Data size:", JSON.stringify(keyframeData).length, "characters")
+        keyframeSaved(frame, keyframeData)
+
+        return keyframeData
+    }
+
+    // Снимок текущего состояния сцены в формате ключевого кадра
+    // (AnimationExporter сохраняет его на время экспорта)
+    function captureSceneState() {
+        sceneStateRequested()
+
+        return {
             version: "1.0",
             timestamp: new Date().toISOString(),
-            frame: frame,
+            frame: -1,
 
             // Состояние камеры
             camera: {
@@ -85,24 +127,7 @@ QtObject {
             },
 
             // Состояние модели
-            model: loadedModel ? {
-                source: loadedModel.source.toString(),
-                position: {
-                    x: loadedModel.position.x,
-                    y: loadedModel.position.y,
-                    z: loadedModel.position.z
-                },
-                rotation: {
-                    x: loadedModel.eulerRotation.x,
-                    y: loadedModel.eulerRotation.y,
-                    z: loadedModel.eulerRotation.z
-                },
-                scale: {
-                    x: loadedModel.scale.x,
-                    y: loadedModel.scale.y,
-                    z: loadedModel.scale.z
-                }
-            } : null,
+            model: loadedModel ? currentModelTransform() : null,
 
             // Состояние костей (если включено управление костями)
             bones: boneManipulator && boneManipulator.manipulationEnabled ? {
@@ -149,27 +174,105 @@ QtObject {
                 antialiasingQuality: view3d.environment.antialiasingQuality
             }
         }
+    }
 
-        keyframes[frame] = keyframeData
+    // Вернуть состояние из captureSceneState после того, как экспорт
+    // проигрывал на сцене свои кадры
+    function restoreSceneState(state) {
+        if (!state) {
+            return false
+        }
 
-        console.log("Keyframe saved for frame", frame + 1, "- Data size:", JSON.stringify(keyframeData).length, "characters")
-        keyframeSaved(frame, keyframeData)
+        var restoreBones = state.bones && state.bones.enabled && boneManipulator && boneManipulator.manipulationEnabled
 
-        return keyframeData
+        // Кости, которых нет в снимке, возвращаем в исходную позу
+        if (restoreBones) {
+            for (var boneIndex in boneManipulator.boneTransforms) {
+                if (!(boneIndex in state.bones.transforms)) {
+                    boneManipulator.resetBone(parseInt(boneIndex))
+                }
+            }
+        }
+
+        if (!applySceneState(state)) {
+            return false
+        }
+
+        // Снятие выделения тоже восстанавливаем
+        if (restoreBones) {
+            boneManipulator.selectBone(state.bones.selectedBoneIndex)
+        }
+
+        console.log("Scene state restored")
+        return true
     }
 
     // Загрузить ключевой кадр и применить к сцене
     function loadKeyframe(frame) {
+        if (sceneLocked) {
+            console.log("Scene is busy with an export, keyframe", frame + 1, "not loaded")
+            return false
+        }
+
         console.log("Loading keyframe for frame:", frame + 1)
 
         var keyframeData = keyframes[frame]
+        if (hasMotion(frame)) {
+            return applyMotionFrame(frame, keyframeData)
+        }
+
         if (!keyframeData) {
             console.log("No keyframe data found for frame", frame + 1)
             return false
         }
 
+        return applyKeyframeData(keyframeData)
+    }
+
+    // Кадр импортированного дубля: сначала ключевой кадр (если есть),
+    // затем кости, снятые с дубля для этого кадра
+    function applyMotionFrame(frame, keyframeData) {
+        if (keyframeData && !applyKeyframeData(keyframeData)) {
+            return false
+        }
+
+        if (!boneManipulator || !boneManipulator.manipulationEnabled) {
+            console.log("Bone manipulation is not enabled, cannot apply motion frame", frame + 1)
+            return !!keyframeData
+        }
+
+        var transforms = motionTrack.sampleFrame(frame, boneManipulator.originalTransforms)
+        for (var boneIndex in transforms) {
+            boneManipulator.setBoneTransform(parseInt(boneIndex), transforms[boneIndex])
+        }
+
+        if (!keyframeData) {
+            keyframeLoaded(frame, { frame: frame })
+        }
+        return true
+    }
+
+    // Применить данные ключевого кадра (в т.ч. снимок из очереди экспорта)
+    function applyKeyframeData(keyframeData) {
+        if (!keyframeData) {
+            return false
+        }
+
+        var frame = keyframeData.frame
         console.log("Applying keyframe data for frame", frame + 1)
 
+        if (!applySceneState(keyframeData)) {
+            console.log("Error applying keyframe", frame + 1)
+            return false
+        }
+
+        console.log("Keyframe", frame + 1, "applied successfully")
+        keyframeLoaded(frame, keyframeData)
+        return true
+    }
+
+    // Применить снимок сцены (ключевой кадр или captureSceneState) без сигнала keyframeLoaded
+    function applySceneState(keyframeData) {
         try {
             // Применяем состояние камеры
             if (keyframeData.camera) {
@@ -212,13 +315,11 @@ QtObject {
 
             // Применяем состояние модели
             if (keyframeData.model && loadedModel) {
-                var modelPos = keyframeData.model.position
-                var modelRot = keyframeData.model.rotation
-                var modelScale = keyframeData.model.scale
-
-                loadedModel.position = Qt.vector3d(modelPos.x, modelPos.y, modelPos.z)
-                loadedModel.eulerRotation = Qt.vector3d(modelRot.x, modelRot.y, modelRot.z)
-                loadedModel.scale = Qt.vector3d(modelScale.x, modelScale.y, modelScale.z)
+                if (modelPinned) {
+                    pinnedModelTransform = JSON.parse(JSON.stringify(keyframeData.model))
+                } else {
+                    setModelTransform(keyframeData.model)
+                }
             }
 
             // Применяем состояние костей
@@ -275,12 +376,10 @@ QtObject {
                 view3d.environment.antialiasingQuality = keyframeData.scene.antialiasingQuality
             }
 
-            console.log("Keyframe", frame + 1, "applied successfully")
-            keyframeLoaded(frame, keyframeData)
             return true
 
         } catch (error) {
-            console.log("Error applying keyframe", frame + 1, ":", error)
+            console.log("Error applying scene state:", error)
             return false
         }
     }
@@ -307,6 +406,24 @@ QtObject {
         return keyframes[frame] !== undefined
     }
 
+    // Кадр покрыт импортированным дублем
+    function hasMotion(frame) {
+        return motionTrack !== null && frame >= motionTrack.startFrame && frame < motionTrack.endFrame
+    }
+
+    // Дубль для очереди экспорта: сам импортер, его положение и исходная поза костей
+    function getMotionTrack() {
+        if (!motionTrack || motionTrack.timelineFrames === 0) {
+            return null
+        }
+
+        return {
+            importer: motionTrack,
+            startFrame: motionTrack.startFrame,
+            restPose: boneManipulator ? boneManipulator.originalTransforms : {}
+        }
+    }
+
     // Получить данные ключевого кадра
     function getKeyframe(frame) {
         return keyframes[frame] || null
@@ -321,6 +438,95 @@ QtObject {
         })
     }
 
+    // Трансформация модели: снятая при закреплении или текущая трансформация узла
+    function currentModelTransform() {
+        if (modelPinned && pinnedModelTransform) {
+            return JSON.parse(JSON.stringify(pinnedModelTransform))
+        }
+
+        return {
+            source: loadedModel.source.toString(),
+            position: {
+                x: loadedModel.position.x,
+                y: loadedModel.position.y,
+                z: loadedModel.position.z
+            },
+            rotation: {
+                x: loadedModel.eulerRotation.x,
+                y: loadedModel.eulerRotation.y,
+                z: loadedModel.eulerRotation.z
+            },
+            scale: {
+                x: loadedModel.scale.x,
+                y: loadedModel.scale.y,
+                z: loadedModel.scale.z
+            }
+        }
+    }
+
+    function setModelTransform(model) {
+        loadedModel.position = Qt.vector3d(model.position.x, model.position.y, model.position.z)
+        loadedModel.eulerRotation = Qt.vector3d(model.rotation.x, model.rotation.y, model.rotation.z)
+        loadedModel.scale = Qt.vector3d(model.scale.x, model.scale.y, model.scale.z)
+
+        // Кости сдвинулись вместе с моделью, выбор лучом должен это учесть
+        if (boneManipulator) {
+            boneManipulator.picker.markDirty()
+        }
+    }
+
+    // Закрепить узел модели в нуле (режим толпы) или вернуть ему трансформацию
+    function pinModelTransform(pinned) {
+        if (!loadedModel || pinned === modelPinned) {
+            return
+        }
+
+        if (pinned) {
+            pinnedModelTransform = currentModelTransform()
+            modelPinned = true
+            setModelTransform({
+                position: { x: 0, y: 0, z: 0 },
+                rotation: { x: 0, y: 0, z: 0 },
+                scale: { x: 1, y: 1, z: 1 }
+            })
+        } else {
+            modelPinned = false
+            if (pinnedModelTransform) {
+                setModelTransform(pinnedModelTransform)
+            }
+            pinnedModelTransform = null
+        }
+    }
+
+    // Трансформации модели по ключевым кадрам (для CrowdInstancing).
+    // Без ключевых кадров - одна запись с текущей трансформацией
+    function getModelTrack() {
+        var track = []
+        var frames = getAllKeyframes()
+        for (var i = 0; i < frames.length; i++) {
+            var model = keyframes[frames[i]].model
+            if (model) {
+                track.push({
+                    frame: frames[i],
+                    position: model.position,
+                    rotation: model.rotation,
+                    scale: model.scale
+                })
+            }
+        }
+
+        if (track.length === 0 && loadedModel) {
+            var current = currentModelTransform()
+            track.push({
+                frame: 0,
+                position: current.position,
+                rotation: current.rotation,
+                scale: current.scale
+            })
+        }
+        return track
+    }
+
     // Экспорт всех ключевых кадров
     function exportKeyframes() {
         var exportData = {
@@ -328,7 +534,8 @@ QtObject {
                 version: "1.0",
                 timestamp: new Date().toISOString(),
                 totalFrames: Object.keys(keyframes).length,
-                application: "Motion Plugin"
+                application: "Motion Plugin",
+                skeleton: skeleton
             },
             keyframes: keyframes
         }
@@ -348,6 +555,7 @@ QtObject {
 
             if (importData.keyframes) {
                 keyframes = importData.keyframes
+                skeleton = importData.metadata ? (importData.metadata.skeleton || null) : null
                 console.log("Keyframes imported successfully. Total:", Object.keys(keyframes).length)
                 return true
             } else {
@@ -360,9 +568,81 @@ QtObject {
         }
     }
 
+    // Поставить импортированный дубль на таймлайн с кадра startFrame.
+    // Кадры не копируются: кости снимаются с дубля при загрузке кадра и экспорте.
+    function setMotionTrack(importer, startFrame) {
+        if (!importer || importer.timelineFrames === 0) {
+            console.log("No imported motion available")
+            motionTrack = null
+            return 0
+        }
+
+        importer.startFrame = startFrame
+        motionTrack = importer
+        console.log("Motion track placed on frames", startFrame + 1, "-", importer.endFrame)
+        return importer.timelineFrames
+    }
+
+    // Трансформации костей по ключевым кадрам (для MotionRetargeter)
+    function getBoneTracks() {
+        var tracks = []
+        var frames = getAllKeyframes()
+        for (var i = 0; i < frames.length; i++) {
+            var bones = keyframes[frames[i]].bones
+            if (bones && bones.enabled) {
+                tracks.push({
+                    frame: frames[i],
+                    transforms: bones.transforms
+                })
+            }
+        }
+        return tracks
+    }
+
+    // Заменить трансформации костей результатом переноса на другой скелет
+    function applyBoneTracks(tracks, targetSkeleton) {
+        for (var i = 0; i < tracks.length; i++) {
+            var keyframeData = keyframes[tracks[i].frame]
+            if (keyframeData && keyframeData.bones) {
+                keyframeData.bones.transforms = tracks[i].transforms
+                keyframeData.bones.selectedBoneIndex = null
+            }
+        }
+
+        skeleton = targetSkeleton
+        console.log("Bone tracks replaced in", tracks.length, "keyframes")
+    }
+
+    // Записать позу живого потока в ключевой кадр
+    function recordPose(frame, transforms) {
+        if (!boneManipulator || !boneManipulator.manipulationEnabled) {
+            console.log("Bone manipulation is not enabled, cannot record pose")
+            return false
+        }
+
+        var keyframeData = keyframes[frame] || saveKeyframe(frame)
+        if (!keyframeData) {
+            return false
+        }
+
+        var merged = keyframeData.bones.enabled ? keyframeData.bones.transforms : {}
+        for (var boneIndex in transforms) {
+            merged[boneIndex] = transforms[boneIndex]
+        }
+
+        keyframeData.bones = {
+            enabled: true,
+            selectedBoneIndex: boneManipulator.selectedBoneIndex,
+            transforms: merged
+        }
+        return true
+    }
+
     // Очистить все ключевые кадры
     function clearAllKeyframes() {
         keyframes = {}
+        skeleton = null
+        motionTrack = null
         console.log("All keyframes cleared")
     }
 }
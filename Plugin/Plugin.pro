@@ -1,4 +1,4 @@
-QT += gui qml quick quick3d opengl widgets quick3dphysics
+QT += gui qml quick quick3d opengl widgets quick3dphysics network
 
 TEMPLATE = lib
 CONFIG += plugin
@@ -20,11 +20,25 @@ CONFIG(debug, debug|release) {
 
 SOURCES += \
     animationexporter.cpp \
-    motionplugin.cpp
+    bonepicker.cpp \
+    crowdinstancing.cpp \
+    motionimporter.cpp \
+    motionplugin.cpp \
+    motionretargeter.cpp \
+    posestream.cpp \
+    yuvconverter.cpp
 
 HEADERS += \
     animationexporter.h \
+    bonepicker.h \
+    boneutils.h \
+    crowdinstancing.h \
+    motionimporter.h \
     motionplugin.h \
+    motionretargeter.h \
+    posestream.h \
+    spscring.h \
+    yuvconverter.h \
     ../common/pluginInterface.h
 
 DISTFILES += Plugin.json \
@@ -32,10 +46,13 @@ DISTFILES += Plugin.json \
     BoneManipulator.qml \
     CameraHelper.qml \
     ControlPanelUI.qml \
+    CrowdWindow.qml \
     ExportWindow.qml \
     GridManager.qml \
     KeyFrameManager.qml \
     PhysicsWindow.qml \
+    PoseStreamWindow.qml \
+    RetargetWindow.qml \
     SkeletonAnalyzer.qml \
     SkeletonWindow.qml \
     TimeLineView.qml \
@@ -0,0 +1,321 @@
+import QtQuick
+import QtQuick.Window
+import QtQuick.Controls
+import QtQuick.Layouts
+import MotionPlugin 1.0
+
+Window {
+    id: root
+    width: 420
+    height: 560
+    visible: false
+    title: "Live Pose Stream"
+    color: "#2a2a2a"
+
+    property alias stream: poseStream
+    property var boneManipulator: null
+    property var keyframeManager: null
+    property var timeline: null
+
+    // Экспорт захватывает сцену: всё, что в нее пишет, отключено
+    property bool sceneLocked: false
+
+    // Частота кадров таймлайна (AnimationExporter.frameRate): один записанный
+    // сэмпл - один кадр, иначе запись проигрывается с другой скоростью
+    property int timelineRate: 24
+
+    // Первый кадр таймлайна, с которого начинается запись
+    property int recordStartFrame: 0
+
+    flags: Qt.Window | Qt.WindowSystemMenuHint | Qt.WindowTitleHint |
+           Qt.WindowMinMaxButtonsHint | Qt.WindowCloseButtonHint
+
+    PoseStream {
+        id: poseStream
+        recordRate: root.timelineRate
+
+        onPoseApplied: {
+            if (boneManipulator) {
+                boneManipulator.picker.markDirty()
+            }
+        }
+
+        onPoseRecorded: function(sample, transforms) {
+            var frame = root.recordStartFrame + sample
+            var lastFrame = timeline ? timeline.totalFrames : 30
+            if (frame >= lastFrame) {
+                console.log("Pose recording reached the end of the timeline")
+                poseStream.recording = false
+                return
+            }
+
+            if (keyframeManager && keyframeManager.recordPose(frame, transforms) && timeline) {
+                timeline.refreshDisplay()
+            }
+        }
+
+        onListeningChanged: {
+            // Ручное редактирование продолжается с последней принятой позы
+            if (!listening) {
+                syncBoneTransforms()
+            }
+        }
+
+        onStreamError: function(message) {
+            console.log("❌ Pose stream:", message)
+        }
+    }
+
+    // Поток пишет в узлы напрямую: сохраняемый кадр должен взять его позу
+    Connections {
+        target: keyframeManager
+        enabled: poseStream.listening
+
+        function onSceneStateRequested() {
+            syncBoneTransforms()
+        }
+    }
+
+    // Кости перестроены - переназначаем узлы потока
+    Connections {
+        target: boneManipulator
+
+        function onBonesListUpdated() {
+            // Узлы и исходные трансформации кэшируются после обновления списка
+            Qt.callLater(bindBones)
+        }
+    }
+
+    ScrollView {
+        anchors.fill: parent
+        anchors.margins: 15
+        enabled: !root.sceneLocked
+
+        Column {
+            spacing: 15
+            width: root.width - 30
+
+            Text {
+                text: "📡 Live Pose Stream"
+                color: "white"
+                font.bold: true
+                font.pixelSize: 18
+            }
+
+            Rectangle {
+                width: parent.width
+                height: connectionColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: connectionColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 8
+
+                    Row {
+                        spacing: 10
+
+                        RadioButton {
+                            text: "UDP"
+                            checked: poseStream.transport === "udp"
+                            enabled: !poseStream.listening
+                            palette.windowText: "white"
+                            onClicked: poseStream.transport = "udp"
+                        }
+
+                        RadioButton {
+                            text: "Local socket"
+                            checked: poseStream.transport === "local"
+                            enabled: !poseStream.listening
+                            palette.windowText: "white"
+                            onClicked: poseStream.transport = "local"
+                        }
+                    }
+
+                    Row {
+                        spacing: 10
+
+                        Text {
+                            text: poseStream.transport === "udp" ? "Port:" : "Name:"
+                            color: "lightgray"
+                            width: 50
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+
+                        TextField {
+                            width: 200
+                            enabled: !poseStream.listening
+                            text: poseStream.transport === "udp" ? poseStream.port : poseStream.serverName
+                            validator: poseStream.transport === "udp" ? portValidator : null
+                            onEditingFinished: {
+                                if (poseStream.transport === "udp") {
+                                    poseStream.port = parseInt(text)
+                                } else {
+                                    poseStream.serverName = text
+                                }
+                            }
+                        }
+                    }
+
+                    Row {
+                        spacing: 10
+
+                        Button {
+                            text: poseStream.listening ? "⏹️ Stop" : "▶️ Listen"
+                            enabled: poseStream.listening ||
+                                     (boneManipulator && boneManipulator.manipulationEnabled)
+                            onClicked: {
+                                if (poseStream.listening) {
+                                    poseStream.stop()
+                                } else {
+                                    bindBones()
+                                    poseStream.start()
+                                }
+                            }
+                        }
+
+                        Button {
+                            text: poseStream.simulating ? "⏹️ Stop simulator" : "🤖 Simulator"
+                            enabled: poseStream.listening || poseStream.simulating
+                            onClicked: {
+                                if (poseStream.simulating) {
+                                    poseStream.stopSimulator()
+                                } else {
+                                    poseStream.startSimulator(120)
+                                }
+                            }
+                            ToolTip.visible: hovered
+                            ToolTip.text: "Тестовый источник: 120 пакетов/с на этот же порт"
+                        }
+                    }
+                }
+            }
+
+            Rectangle {
+                width: parent.width
+                height: recordColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: recordColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 8
+
+                    Switch {
+                        text: "⏺️ Record into keyframes"
+                        checked: poseStream.recording
+                        enabled: poseStream.listening
+                        palette.windowText: "white"
+                        onToggled: {
+                            if (checked) {
+                                root.recordStartFrame = timeline ? timeline.currentFrame : 0
+                            }
+                            poseStream.recording = checked
+                        }
+                    }
+
+                    Text {
+                        text: "Record rate: " + poseStream.recordRate.toFixed(0) + " keyframes/s (timeline frame rate)"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: "• Recording starts at the current timeline frame and stops at its end"
+                        color: "#cccccc"
+                        font.pixelSize: 10
+                        wrapMode: Text.WordWrap
+                        width: parent.width
+                    }
+                }
+            }
+
+            Rectangle {
+                width: parent.width
+                height: statsColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: statsColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 6
+
+                    Text {
+                        text: "📊 Stream"
+                        color: "lightgreen"
+                        font.bold: true
+                        font.pixelSize: 14
+                    }
+
+                    Text {
+                        text: "• Packets: " + poseStream.packetsReceived + " received, " +
+                              poseStream.packetsDropped + " dropped"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: "• Latency (packet → frame): " + poseStream.latency.toFixed(2) + " ms"
+                        color: poseStream.latency < 8.3 ? "#4CAF50" : "#FF9800"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: poseStream.status
+                        color: "white"
+                        font.pixelSize: 12
+                        wrapMode: Text.WordWrap
+                        width: parent.width
+                    }
+                }
+            }
+
+            Text {
+                text: "💡 Packets address bones by node index; the newest pose is applied once per rendered frame."
+                color: "#cccccc"
+                font.pixelSize: 10
+                wrapMode: Text.WordWrap
+                width: parent.width
+            }
+        }
+    }
+
+    IntValidator {
+        id: portValidator
+        bottom: 1
+        top: 65535
+    }
+
+    function bindBones() {
+        if (boneManipulator && boneManipulator.manipulationEnabled) {
+            poseStream.setBones(boneManipulator.modelNodes, boneManipulator.originalTransforms)
+        }
+    }
+
+    // Последняя принятая поза в boneManipulator.boneTransforms
+    function syncBoneTransforms() {
+        if (!boneManipulator) {
+            return
+        }
+
+        var transforms = poseStream.currentTransforms()
+        for (var boneIndex in transforms) {
+            boneManipulator.boneTransforms[boneIndex] = transforms[boneIndex]
+        }
+    }
+}
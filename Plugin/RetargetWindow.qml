@@ -0,0 +1,245 @@
+import QtQuick
+import QtQuick.Window
+import QtQuick.Controls
+import QtQuick.Layouts
+import MotionPlugin 1.0
+
+Window {
+    id: root
+    width: 460
+    height: 620
+    visible: false
+    title: "Motion Retargeting"
+    color: "#2a2a2a"
+
+    property alias retargeter: retargeter
+    property var boneManipulator: null
+    property var keyframeManager: null
+    property var timeline: null
+
+    // Экспорт захватывает сцену: всё, что в нее пишет, отключено
+    property bool sceneLocked: false
+
+    // Профиль скелета загруженной модели
+    property var targetProfile: null
+
+    flags: Qt.Window | Qt.WindowSystemMenuHint | Qt.WindowTitleHint |
+           Qt.WindowMinMaxButtonsHint | Qt.WindowCloseButtonHint
+
+    MotionRetargeter {
+        id: retargeter
+
+        onMappingChanged: mappingView.model = retargeter.mapping()
+
+        onRetargetCompleted: function(success, message, frames) {
+            console.log(success ? "✅" : "❌", "Retarget:", message)
+            if (!success || !keyframeManager) {
+                return
+            }
+
+            // Кадры теперь относятся к скелету загруженной модели
+            keyframeManager.applyBoneTracks(frames, root.targetProfile)
+            retargeter.setSourceSkeleton(root.targetProfile)
+            if (timeline) {
+                if (keyframeManager.hasKeyframe(timeline.currentFrame)) {
+                    keyframeManager.loadKeyframe(timeline.currentFrame)
+                }
+                timeline.refreshDisplay()
+            }
+        }
+    }
+
+    // Новая модель или пересобранный список костей
+    Connections {
+        target: boneManipulator
+
+        function onBonesListUpdated() {
+            // Узлы и исходные трансформации кэшируются после обновления списка
+            Qt.callLater(updateSkeletons)
+        }
+    }
+
+    ScrollView {
+        anchors.fill: parent
+        anchors.margins: 15
+        enabled: !root.sceneLocked
+
+        Column {
+            spacing: 15
+            width: root.width - 30
+
+            Text {
+                text: "🔁 Motion Retargeting"
+                color: "white"
+                font.bold: true
+                font.pixelSize: 18
+            }
+
+            Rectangle {
+                width: parent.width
+                height: infoColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: infoColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 6
+
+                    Text {
+                        text: "• Keyframe skeleton: " + retargeter.sourceBones + " bones"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: "• Loaded model: " + retargeter.targetBones + " bones"
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: "• Mapped: " + retargeter.mappedBones + " bones, scale " + retargeter.scale.toFixed(3)
+                        color: retargeter.mappedBones > 0 ? "#4CAF50" : "#FF9800"
+                        font.pixelSize: 12
+                    }
+
+                    Text {
+                        text: "• Cached mappings: " + retargeter.cachedMappings
+                        color: "lightgray"
+                        font.pixelSize: 12
+                    }
+
+                    Button {
+                        text: "📌 Use loaded model as keyframe skeleton"
+                        enabled: root.targetProfile !== null && !retargeter.isRetargeting
+                        onClicked: {
+                            keyframeManager.skeleton = root.targetProfile
+                            retargeter.setSourceSkeleton(root.targetProfile)
+                        }
+                        ToolTip.visible: hovered
+                        ToolTip.text: "Для кадров, созданных до появления переноса анимации"
+                    }
+                }
+            }
+
+            Rectangle {
+                width: parent.width
+                height: 220
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                ListView {
+                    id: mappingView
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    clip: true
+                    spacing: 2
+
+                    ScrollBar.vertical: ScrollBar { }
+
+                    delegate: Text {
+                        width: mappingView.width
+                        text: modelData.sourceName + " → " + modelData.targetName +
+                              "  (" + modelData.method + ", ×" + modelData.lengthRatio.toFixed(2) + ")"
+                        color: modelData.method === "hierarchy" ? "#FFB74D" : "lightgray"
+                        font.pixelSize: 11
+                        elide: Text.ElideRight
+                    }
+
+                    Text {
+                        anchors.centerIn: parent
+                        visible: mappingView.count === 0
+                        text: "No bone mapping yet"
+                        color: "#888888"
+                        font.pixelSize: 12
+                    }
+                }
+            }
+
+            Rectangle {
+                width: parent.width
+                height: actionColumn.height + 20
+                color: "#333333"
+                border.color: "#666666"
+                radius: 5
+
+                Column {
+                    id: actionColumn
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    anchors.verticalCenter: parent.verticalCenter
+                    spacing: 8
+
+                    Row {
+                        spacing: 10
+
+                        Button {
+                            text: "🔁 Retarget keyframes"
+                            enabled: retargeter.mappedBones > 0 && !retargeter.isRetargeting
+                            onClicked: retargeter.startRetarget(keyframeManager.getBoneTracks())
+                        }
+
+                        Button {
+                            text: "⏹️ Cancel"
+                            enabled: retargeter.isRetargeting
+                            onClicked: retargeter.cancelRetarget()
+                        }
+
+                        Button {
+                            text: "🗑️ Clear cache"
+                            enabled: retargeter.cachedMappings > 0 && !retargeter.isRetargeting
+                            onClicked: retargeter.clearCache()
+                        }
+                    }
+
+                    ProgressBar {
+                        width: parent.width
+                        from: 0
+                        to: 1
+                        value: retargeter.progress
+                        visible: retargeter.isRetargeting
+                    }
+
+                    Text {
+                        text: retargeter.status
+                        color: "white"
+                        font.pixelSize: 12
+                        wrapMode: Text.WordWrap
+                        width: parent.width
+                    }
+                }
+            }
+
+            Text {
+                text: "💡 Bones are matched by name, then by hierarchy. Rotations keep their motion relative to each rig's rest pose; translations are scaled by bone length."
+                color: "#cccccc"
+                font.pixelSize: 10
+                wrapMode: Text.WordWrap
+                width: parent.width
+            }
+        }
+    }
+
+    function updateSkeletons() {
+        if (!boneManipulator || !boneManipulator.manipulationEnabled || boneManipulator.bonesList.length === 0) {
+            return
+        }
+
+        targetProfile = retargeter.skeletonProfile(boneManipulator.bonesList, boneManipulator.originalTransforms)
+
+        // Новые кадры относятся к первой модели, на которой их создали
+        if (keyframeManager && (!keyframeManager.skeleton || keyframeManager.getBoneTracks().length === 0)) {
+            keyframeManager.skeleton = targetProfile
+        }
+
+        retargeter.setSourceSkeleton(keyframeManager ? keyframeManager.skeleton : targetProfile)
+        retargeter.setTargetSkeleton(targetProfile)
+    }
+}
@@ -10,6 +10,11 @@ Rectangle {
     property int currentFrame: 0
     property var keyframeManager: null // Ссылка на KeyframeManager
 
+    // Ячейки кадров тянутся на всю ширину, но не уже minFrameWidth;
+    // длинный таймлайн (импортированный дубль) прокручивается
+    readonly property real minFrameWidth: 28
+    readonly property real frameWidth: Math.max(minFrameWidth, (width - 16 - (totalFrames - 1)) / totalFrames)
+
     // Внешний вид
     color: "#2a2a2a"
     border.color: "#666666"
@@ -49,7 +54,7 @@ Rectangle {
             Item { Layout.fillWidth: true }
 
             Text {
-                text: "30 frames available"
+                text: totalFrames + " frames available"
                 color: "#888888"
                 font.pixelSize: 12
                 anchors.verticalCenter: parent.verticalCenter
@@ -62,16 +67,28 @@ Rectangle {
             color: "#555555"
         }
 
-        // Номера кадров
-        Row {
-            id: frameNumbers
+        // Кадры: номера и полоса таймлайна. Создаются только видимые ячейки
+        ListView {
+            id: frameList
+            width: parent.width
+            height: 20 + 5 + 40
+            orientation: ListView.Horizontal
             spacing: 1
+            clip: true
+            boundsBehavior: Flickable.StopAtBounds
+            model: totalFrames
 
-            Repeater {
-                model: totalFrames
+            ScrollBar.horizontal: ScrollBar {
+                policy: frameList.contentWidth > frameList.width ? ScrollBar.AsNeeded : ScrollBar.AlwaysOff
+            }
 
+            delegate: Column {
+                width: root.frameWidth
+                spacing: 5
+
+                // Номер кадра
                 Rectangle {
-                    width: (root.width - 16 - (totalFrames - 1)) / totalFrames
+                    width: parent.width
                     height: 20
                     color: "transparent"
 
@@ -82,21 +99,10 @@ Rectangle {
                         font.pixelSize: 8
                     }
                 }
-            }
-        }
-
-        // Основная полоса таймлайна
-        Row {
-            id: timelineRow
-            spacing: 1
-
-            Repeater {
-                id: frameRepeater
-                model: totalFrames
 
                 Rectangle {
                     id: frameRect
-                    width: (root.width - 16 - (totalFrames - 1)) / totalFrames
+                    width: parent.width
                     height: 40
 
                     // Сохраняем index в property для использования в MouseArea
@@ -108,6 +114,8 @@ Rectangle {
                             return "#FF9800" // Оранжевый для ключевых кадров
                         } else if (frameIndex === currentFrame) {
                             return "#4CAF50" // Зеленый для текущего кадра
+                        } else if (keyframeManager && keyframeManager.hasMotion(frameIndex)) {
+                            return "#3F6FA0" // Синий для кадров импортированного дубля
                         } else {
                             return "#666666" // Серый для обычных кадров
                         }
@@ -163,8 +171,8 @@ Rectangle {
                                     currentFrame = frameRect.frameIndex
                                     frameSelected(frameRect.frameIndex)
 
-                                    // Если это ключевой кадр, загружаем его
-                                    if (keyframeManager && keyframeManager.hasKeyframe(frameRect.frameIndex)) {
+                                    // Если это ключевой кадр или кадр дубля, загружаем его
+                                    if (hasFrameData(frameRect.frameIndex)) {
                                         keyframeLoadRequested(frameRect.frameIndex)
                                         console.log("Loading keyframe for frame", frameRect.frameIndex + 1)
                                     }
@@ -232,8 +240,8 @@ Rectangle {
             currentFrame = frame
             frameSelected(frame)
 
-            // Автоматически загружаем ключевой кадр, если он есть
-            if (keyframeManager && keyframeManager.hasKeyframe(frame)) {
+            // Автоматически загружаем ключевой кадр или кадр дубля, если он есть
+            if (hasFrameData(frame)) {
                 keyframeLoadRequested(frame)
             }
         }
@@ -243,12 +251,21 @@ Rectangle {
         return keyframeManager ? keyframeManager.hasKeyframe(frame) : false
     }
 
+    // Ключевой кадр или кадр импортированного дубля
+    function hasFrameData(frame) {
+        return keyframeManager ? (keyframeManager.hasKeyframe(frame) || keyframeManager.hasMotion(frame)) : false
+    }
+
     function refreshDisplay() {
-        // Принудительное обновление отображения
-        frameRepeater.model = 0
-        frameRepeater.model = totalFrames
+        // Принудительное обновление отображения, прокрутка сохраняется
+        var firstVisible = Math.max(0, frameList.indexAt(frameList.contentX + 1, 1))
+        frameList.model = 0
+        frameList.model = totalFrames
+        frameList.positionViewAtIndex(Math.min(firstVisible, totalFrames - 1), ListView.Beginning)
     }
 
+    onCurrentFrameChanged: frameList.positionViewAtIndex(currentFrame, ListView.Contain)
+
     // Соединения для обновления интерфейса
     Connections {
         target: keyframeManager
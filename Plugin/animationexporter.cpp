@@ -1,11 +1,71 @@
 #include "AnimationExporter.h"
+#include "yuvconverter.h"
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QImageWriter>
 #include <QMetaObject>
 #include <QVariant>
+#include <QJSValue>
 #include <algorithm>
 
+namespace {
+
+// Frames that may wait in the pipe to FFmpeg before capture pauses
+constexpr int MaxQueuedFrames = 4;
+
+QString jobStateName(ExportJob::State state)
+{
+    switch (state) {
+    case ExportJob::Queued: return "queued";
+    case ExportJob::Starting: return "starting";
+    case ExportJob::Capturing: return "capturing";
+    case ExportJob::Encoding: return "encoding";
+    case ExportJob::Finished: return "finished";
+    case ExportJob::Failed: return "failed";
+    case ExportJob::Cancelled: return "cancelled";
+    }
+    return QString();
+}
+
+// QML functions hand objects back as QJSValue, turn them into plain variants
+QVariant toPlainVariant(const QVariant &value)
+{
+    if (value.userType() == qMetaTypeId<QJSValue>()) {
+        return value.value<QJSValue>().toVariant();
+    }
+    return value;
+}
+
+// Keyframe data of one captured frame: the keyframe snapshot, if any, with the
+// bones of the imported take sampled on top
+QVariant jobFrameData(const ExportJob &job, int frame)
+{
+    QVariantMap data = job.keyframes.value(frame).toMap();
+    data["frame"] = frame;
+
+    if (job.motion && frame >= job.motionStart && frame < job.motionStart + job.motionFrames) {
+        const QVariantMap sampled = MotionImporter::sampleBoneTransforms(
+            *job.motion, double(frame - job.motionStart) / job.frameRate, job.motionRestPose);
+
+        QVariantMap bones = data.value("bones").toMap();
+        QVariantMap transforms = bones.value("enabled").toBool() ? bones.value("transforms").toMap() : QVariantMap();
+        for (auto it = sampled.cbegin(); it != sampled.cend(); ++it) {
+            transforms.insert(it.key(), it.value());
+        }
+
+        bones["enabled"] = true;
+        bones["transforms"] = transforms;
+        if (!bones.contains("selectedBoneIndex")) {
+            bones["selectedBoneIndex"] = QVariant::fromValue(nullptr);
+        }
+        data["bones"] = bones;
+    }
+
+    return data;
+}
+
+} // namespace
+
 AnimationExporter::AnimationExporter(QObject *parent)
     : QObject(parent)
     , m_keyframeManager(nullptr)
@@ -17,8 +77,12 @@ AnimationExporter::AnimationExporter(QObject *parent)
     , m_status("Ready")
     , m_renderWidth(1920)
     , m_renderHeight(1080)
+    , m_captureJob(nullptr)
+    , m_nextJobId(1)
+    , m_maxConcurrentEncodes(2)
     , m_captureTimer(new QTimer(this))
-    , m_ffmpegProcess(new QProcess(this))
+    , m_viewportBusy(false)
+    , m_waitingForEncoder(false)
     , m_context(nullptr)
     , m_surface(nullptr)
     , m_fbo(nullptr)
@@ -26,11 +90,6 @@ AnimationExporter::AnimationExporter(QObject *parent)
     m_captureTimer->setSingleShot(true);
     connect(m_captureTimer, &QTimer::timeout, this, &AnimationExporter::captureNextFrame);
 
-    connect(m_ffmpegProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &AnimationExporter::onFFmpegFinished);
-    connect(m_ffmpegProcess, &QProcess::errorOccurred,
-            this, &AnimationExporter::onFFmpegError);
-
     // Setup default export path
     QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
     if (defaultPath.isEmpty()) {
@@ -41,6 +100,19 @@ AnimationExporter::AnimationExporter(QObject *parent)
 
 AnimationExporter::~AnimationExporter()
 {
+    m_captureTimer->stop();
+
+    for (ExportJob *job : std::as_const(m_jobs)) {
+        if (job->process) {
+            job->process->disconnect(this);
+            if (job->process->state() != QProcess::NotRunning) {
+                job->process->kill();
+            }
+        }
+    }
+    qDeleteAll(m_jobs);
+    m_jobs.clear();
+
     cleanup();
 }
 
@@ -74,51 +146,81 @@ void AnimationExporter::setFrameRate(int rate)
     }
 }
 
-void AnimationExporter::startExport(QObject *keyframeManager, QObject *view3d, int width, int height)
+void AnimationExporter::setMaxConcurrentEncodes(int count)
 {
-    if (m_isExporting) {
-        qDebug() << "Export already in progress";
-        return;
+    if (m_maxConcurrentEncodes != count && count > 0) {
+        m_maxConcurrentEncodes = count;
+        emit maxConcurrentEncodesChanged();
+        scheduleJobs();
     }
+}
 
+QVariantList AnimationExporter::jobs() const
+{
+    QVariantList result;
+    result.reserve(m_jobs.size());
+
+    for (const ExportJob *job : m_jobs) {
+        const int total = job->frames.size();
+        QVariantMap entry;
+        entry["id"] = job->id;
+        entry["state"] = jobStateName(job->state);
+        entry["outputPath"] = job->outputPath;
+        entry["width"] = job->width;
+        entry["height"] = job->height;
+        entry["frameRate"] = job->frameRate;
+        entry["capturedFrames"] = job->capturedFrames;
+        entry["totalFrames"] = total;
+        entry["progress"] = job->state == ExportJob::Finished ? 1.0
+                            : total > 0 ? double(job->capturedFrames) / total : 0.0;
+        entry["message"] = job->message;
+        result.append(entry);
+    }
+
+    return result;
+}
+
+int AnimationExporter::enqueueExport(QObject *keyframeManager, QObject *view3d, int width, int height)
+{
     if (!keyframeManager || !view3d) {
         setStatus("Error: Invalid keyframe manager or view3d");
-        emit exportCompleted(false, "Invalid objects provided");
-        return;
+        emit exportCompleted(false, "Invalid objects provided", -1, "failed");
+        return -1;
     }
 
     // Check FFmpeg availability
     if (!checkFFmpegAvailable()) {
         setStatus("Error: FFmpeg not found");
-        emit exportCompleted(false, "FFmpeg executable not found. Please ensure ffmpeg.exe is in the project directory.");
-        return;
+        emit exportCompleted(false, "FFmpeg executable not found. Please ensure ffmpeg.exe is in the project directory.", -1, "failed");
+        return -1;
     }
 
-    m_keyframeManager = keyframeManager;
-    m_view3d = view3d;
-    m_renderWidth = width;
-    m_renderHeight = height;
-
     // Get keyframes list from keyframe manager
     QVariant keyframesVar;
-    bool success = QMetaObject::invokeMethod(m_keyframeManager, "getAllKeyframes",
+    bool success = QMetaObject::invokeMethod(keyframeManager, "getAllKeyframes",
                                              Q_RETURN_ARG(QVariant, keyframesVar));
 
     if (!success) {
         setStatus("Error: Failed to get keyframes");
-        emit exportCompleted(false, "Failed to get keyframes from manager");
-        return;
+        emit exportCompleted(false, "Failed to get keyframes from manager", -1, "failed");
+        return -1;
     }
 
-    QVariantList keyframesList = keyframesVar.toList();
-    if (keyframesList.isEmpty()) {
+    QVariantList keyframesList = toPlainVariant(keyframesVar).toList();
+
+    // The imported take, if one is placed on the timeline
+    QVariant motionVar;
+    QMetaObject::invokeMethod(keyframeManager, "getMotionTrack", Q_RETURN_ARG(QVariant, motionVar));
+    const QVariantMap motionTrack = toPlainVariant(motionVar).toMap();
+    auto *importer = qobject_cast<MotionImporter *>(motionTrack.value("importer").value<QObject *>());
+    const QSharedPointer<const MotionClip> motion = importer ? importer->clip() : QSharedPointer<const MotionClip>();
+
+    if (keyframesList.isEmpty() && !motion) {
         setStatus("Error: No keyframes found");
-        emit exportCompleted(false, "No keyframes found. Please create some keyframes first.");
-        return;
+        emit exportCompleted(false, "No keyframes found. Please create some keyframes first.", -1, "failed");
+        return -1;
     }
 
-    // Convert to string list and sort
-    m_keyframes.clear();
     QList<int> frameNumbers;
     for (const QVariant &frame : keyframesList) {
         frameNumbers.append(frame.toInt());
@@ -127,48 +229,107 @@ void AnimationExporter::startExport(QObject *keyframeManager, QObject *view3d, i
     // Sort frame numbers
     std::sort(frameNumbers.begin(), frameNumbers.end());
 
-    // Convert back to string list
+    // Snapshot the keyframe data, so editing keyframes later doesn't change queued jobs.
+    // The take is immutable and shared, only its placement is copied.
+    auto job = new ExportJob;
+    job->id = m_nextJobId++;
+    job->keyframeManager = keyframeManager;
+    job->view3d = view3d;
+    job->outputPath = availableOutputPath(m_exportPath);
+    job->width = width;
+    job->height = height;
+    job->frameRate = m_frameRate;
+
     for (int frameNum : frameNumbers) {
-        m_keyframes.append(QString::number(frameNum));
+        QVariant keyframeData;
+        if (QMetaObject::invokeMethod(keyframeManager, "getKeyframe",
+                                      Q_RETURN_ARG(QVariant, keyframeData),
+                                      Q_ARG(QVariant, frameNum))) {
+            keyframeData = toPlainVariant(keyframeData);
+            if (keyframeData.toMap().contains("frame")) {
+                job->keyframes.insert(frameNum, keyframeData);
+                job->frames.append(frameNum);
+            }
+        }
     }
 
-    m_totalFrames = m_keyframes.size();
-    m_currentFrame = 0;
-    m_capturedFrames.clear();
+    if (motion) {
+        job->motion = motion;
+        job->motionStart = motionTrack.value("startFrame").toInt();
+        job->motionFrames = MotionImporter::timelineFrameCount(*motion, job->frameRate);
+        job->motionRestPose = motionTrack.value("restPose").toMap();
 
-    emit totalFramesChanged();
-    emit currentFrameChanged();
+        for (int frame = job->motionStart; frame < job->motionStart + job->motionFrames; ++frame) {
+            job->frames.append(frame);
+        }
+        std::sort(job->frames.begin(), job->frames.end());
+        job->frames.erase(std::unique(job->frames.begin(), job->frames.end()), job->frames.end());
+    }
 
-    setupDirectories();
+    if (job->frames.isEmpty()) {
+        delete job;
+        setStatus("Error: Failed to get keyframes");
+        emit exportCompleted(false, "Failed to get keyframes from manager", -1, "failed");
+        return -1;
+    }
 
-    m_isExporting = true;
-    emit isExportingChanged();
+    m_jobs.append(job);
+    qDebug() << "Queued export job" << job->id << "with" << job->frames.size() << "frames ("
+             << job->keyframes.size() << "keyframes," << job->motionFrames << "motion frames) to" << job->outputPath;
 
-    setStatus("Starting export...");
-    qDebug() << "Starting animation export with" << m_totalFrames << "keyframes";
+    if (job->outputPath != m_exportPath) {
+        setStatus(QString("Export #%1 queued as %2, the file is already being exported")
+                      .arg(job->id).arg(QFileInfo(job->outputPath).fileName()));
+    } else {
+        setStatus(QString("Export #%1 queued").arg(job->id));
+    }
+    emit jobsChanged();
+    updateExportingState();
+    scheduleJobs();
 
-    // Start capturing frames
-    m_captureTimer->start(100); // Small delay to let UI update
+    return job->id;
 }
 
-void AnimationExporter::stopExport()
+void AnimationExporter::startExport(QObject *keyframeManager, QObject *view3d, int width, int height)
 {
-    if (!m_isExporting) return;
-
-    m_captureTimer->stop();
+    enqueueExport(keyframeManager, view3d, width, height);
+}
 
-    if (m_ffmpegProcess->state() != QProcess::NotRunning) {
-        m_ffmpegProcess->kill();
-        m_ffmpegProcess->waitForFinished(3000);
+void AnimationExporter::stopExport()
+{
+    const QList<ExportJob *> jobs = m_jobs;
+    for (ExportJob *job : jobs) {
+        if (!job->isDone()) {
+            finishJob(job, ExportJob::Cancelled, "Export was cancelled by user");
+        }
     }
+}
 
-    m_isExporting = false;
-    emit isExportingChanged();
+void AnimationExporter::cancelJob(int jobId)
+{
+    ExportJob *job = findJob(jobId);
+    if (!job || job->isDone()) return;
 
-    setStatus("Export cancelled");
-    cleanup();
+    finishJob(job, ExportJob::Cancelled, "Export was cancelled by user");
+}
+
+void AnimationExporter::clearFinishedJobs()
+{
+    bool removed = false;
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        // Processes that were killed are released once they report back
+        if ((*it)->isDone() && !(*it)->process) {
+            delete *it;
+            it = m_jobs.erase(it);
+            removed = true;
+        } else {
+            ++it;
+        }
+    }
 
-    emit exportCompleted(false, "Export was cancelled by user");
+    if (removed) {
+        emit jobsChanged();
+    }
 }
 
 bool AnimationExporter::checkFFmpegAvailable()
@@ -182,344 +343,435 @@ bool AnimationExporter::checkFFmpegAvailable()
     return available;
 }
 
+void AnimationExporter::scheduleJobs()
+{
+    // The view can only show one job's keyframes at a time
+    if (m_captureJob) return;
+    if (runningEncoders() >= m_maxConcurrentEncodes) return;
+
+    for (ExportJob *job : std::as_const(m_jobs)) {
+        if (job->state == ExportJob::Queued) {
+            if (!job->keyframeManager || !job->view3d) {
+                finishJob(job, ExportJob::Failed, "Keyframe manager or view3d no longer exists");
+                return;
+            }
+            startEncoder(job);
+            return;
+        }
+    }
+}
+
+void AnimationExporter::startEncoder(ExportJob *job)
+{
+    // Frames are converted to YUV420 here and piped to FFmpeg as raw video,
+    // so FFmpeg neither decodes PNGs nor converts pixel formats itself
+    QString ffmpegPath = getFFmpegPath();
+    QString outputPath = QDir::toNativeSeparators(job->outputPath);
+
+    QFileInfo outputInfo(outputPath);
+    QDir outputDir = outputInfo.dir();
+    if (!outputDir.exists()) {
+        outputDir.mkpath(".");
+        qDebug() << "Created output directory:" << outputDir.absolutePath();
+    }
+
+    QStringList arguments;
+    arguments << "-y" // Overwrite output file
+              << "-f" << "rawvideo"
+              << "-pix_fmt" << "yuv420p"
+              << "-s" << QString("%1x%2").arg(job->width).arg(job->height)
+              << "-framerate" << QString::number(job->frameRate)
+              << "-i" << "-" // Frames come from stdin
+              << "-c:v" << "libx264"
+              << "-pix_fmt" << "yuv420p"
+              << "-preset" << "medium"
+              << "-crf" << "18" // High quality
+              << outputPath;
+
+    qDebug() << "Starting FFmpeg for job" << job->id << "with arguments:" << arguments;
+    qDebug() << "YUV conversion kernel:" << YuvConverter::kernelName(YuvConverter::bestKernel());
+
+    job->process = new QProcess(this);
+    connect(job->process, &QProcess::started, this, [this, job]() {
+        beginCapture(job);
+    });
+    connect(job->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        onFFmpegFinished(job, exitCode, exitStatus);
+    });
+    connect(job->process, &QProcess::bytesWritten, this, [this, job]() {
+        onEncoderDrained(job);
+    });
+    connect(job->process, &QProcess::errorOccurred, this, [this, job](QProcess::ProcessError error) {
+        onFFmpegError(job, error);
+    });
+
+    job->state = ExportJob::Starting;
+    m_captureJob = job;
+    setStatus(QString("Export #%1: starting FFmpeg...").arg(job->id));
+    emit jobsChanged();
+
+    // No waitForStarted(): capture begins from the started() signal
+    job->process->start(ffmpegPath, arguments);
+}
+
+void AnimationExporter::beginCapture(ExportJob *job)
+{
+    if (job != m_captureJob || job->state != ExportJob::Starting) return;
+
+    job->state = ExportJob::Capturing;
+
+    m_keyframeManager = job->keyframeManager;
+    m_view3d = job->view3d;
+    m_renderWidth = job->width;
+    m_renderHeight = job->height;
+    m_yuvBuffer.resize(YuvConverter::frameSize(m_renderWidth, m_renderHeight));
+
+    // Keep what the user was looking at, the job's frames overwrite it
+    QVariant sceneState;
+    if (QMetaObject::invokeMethod(m_keyframeManager, "captureSceneState", Q_RETURN_ARG(QVariant, sceneState))) {
+        m_sceneState = toPlainVariant(sceneState);
+    } else {
+        qDebug() << "Failed to save the scene state before export" << job->id;
+    }
+    m_viewportBusy = true;
+    emit viewportBusyChanged();
+
+    m_totalFrames = job->frames.size();
+    m_currentFrame = 0;
+    emit totalFramesChanged();
+    emit currentFrameChanged();
+    emit jobsChanged();
+
+    setStatus(QString("Export #%1: starting capture...").arg(job->id));
+    qDebug() << "Starting animation export" << job->id << "with" << m_totalFrames << "frames";
+
+    // Start capturing once the started() handler has returned
+    m_captureTimer->start(0);
+}
+
 void AnimationExporter::captureNextFrame()
 {
-    if (!m_isExporting || m_currentFrame >= m_totalFrames) {
+    ExportJob *job = m_captureJob;
+    if (!job || job->state != ExportJob::Capturing) return;
+
+    if (m_currentFrame >= m_totalFrames) {
         // All frames captured, generate video
         generateVideo();
         return;
     }
 
-    int frameIndex = m_keyframes[m_currentFrame].toInt();
-    setStatus(QString("Capturing frame %1 of %2 (keyframe %3)")
+    const int frameIndex = job->frames.at(m_currentFrame);
+    const QVariant keyframeData = jobFrameData(*job, frameIndex);
+    setStatus(QString("Export #%1: capturing frame %2 of %3 (timeline frame %4)")
+                  .arg(job->id)
                   .arg(m_currentFrame + 1)
                   .arg(m_totalFrames)
                   .arg(frameIndex + 1));
 
     emit exportProgress(m_currentFrame + 1, m_totalFrames, m_status);
 
-    // Load keyframe
-    loadKeyframe(frameIndex);
-
-    // Capture frame after small delay to let scene update
-    QTimer::singleShot(200, [this, frameIndex]() {
-        captureFrame(frameIndex);
-        m_currentFrame++;
-        emit currentFrameChanged();
-
-        // Schedule next frame capture
-        m_captureTimer->start(100);
-    });
+    // Load keyframe. The grab renders the next frame, so it already shows it.
+    loadKeyframe(keyframeData);
+    captureFrame(frameIndex);
 }
 
-void AnimationExporter::setupDirectories()
+void AnimationExporter::captureFrame(int frameIndex)
 {
-    // Create temporary directory for frames
-    m_tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation) +
-                "/MotionPlugin_" + QString::number(QCoreApplication::applicationPid());
+    // View3D is rendered on its own into a texture of the export size: no
+    // window grab, no UI drawn over the scene, nothing to hide or crop
+    QQuickItem *view3dItem = qobject_cast<QQuickItem*>(m_view3d);
+    if (view3dItem) {
+        m_grab = view3dItem->grabToImage(QSize(m_renderWidth, m_renderHeight));
+    }
+    if (!m_grab) {
+        qDebug() << "Failed to grab view3d for frame" << frameIndex;
+        finishJob(m_captureJob, ExportJob::Failed, "Failed to capture frame " + QString::number(frameIndex));
+        return;
+    }
 
-    QDir().mkpath(m_tempDir);
-    qDebug() << "Created temp directory:" << m_tempDir;
+    // Released in frameGrabbed() or releaseView(), a cancelled job never sees the result
+    connect(m_grab.data(), &QQuickItemGrabResult::ready, this, [this, frameIndex]() {
+        frameGrabbed(frameIndex);
+    });
 }
 
-void AnimationExporter::captureFrame(int frameIndex)
+void AnimationExporter::frameGrabbed(int frameIndex)
 {
-    // Находим и временно скрываем таймлайн
-    QQuickItem *timeline = nullptr;
-    if (m_view3d) {
-        QQuickItem *view3dItem = qobject_cast<QQuickItem*>(m_view3d);
-        if (view3dItem && view3dItem->window()) {
-            // Ищем таймлайн в корневом элементе окна
-            QQuickItem *rootItem = view3dItem->window()->contentItem();
-            timeline = findTimelineItem(rootItem);
-        }
+    const QImage frame = m_grab ? m_grab->image() : QImage();
+    m_grab.reset();
+    if (!m_captureJob) return;
+
+    if (frame.isNull()) {
+        qDebug() << "Failed to capture frame" << frameIndex;
+        finishJob(m_captureJob, ExportJob::Failed, "Failed to capture frame " + QString::number(frameIndex));
+        return;
     }
 
-    bool timelineWasVisible = false;
-    if (timeline) {
-        timelineWasVisible = timeline->isVisible();
-        timeline->setVisible(false);
-        qDebug() << "Timeline hidden for capture";
+    if (!writeFrame(frame)) {
+        qDebug() << "Failed to write frame" << frameIndex;
+        finishJob(m_captureJob, ExportJob::Failed, "Failed to write frame " + QString::number(frameIndex));
+        return;
     }
 
-    // Небольшая задержка для обновления UI
-    QTimer::singleShot(50, [this, frameIndex, timeline, timelineWasVisible]() {
-        QImage frame = captureView3D();
+    m_captureJob->capturedFrames++;
+    qDebug() << "Captured frame" << frameIndex << "(" << m_captureJob->capturedFrames << "written)";
+    emit jobsChanged();
 
-        // Восстанавливаем видимость таймлайна
-        if (timeline) {
-            timeline->setVisible(timelineWasVisible);
-            qDebug() << "Timeline visibility restored";
-        }
+    m_currentFrame++;
+    emit currentFrameChanged();
 
-        if (frame.isNull()) {
-            qDebug() << "Failed to capture frame" << frameIndex;
-            setStatus("Error: Failed to capture frame " + QString::number(frameIndex));
-            stopExport();
-            return;
-        }
+    // A slow encoder must not pile frames up in the process buffer
+    if (m_captureJob->process->bytesToWrite() > encoderBufferLimit()) {
+        m_waitingForEncoder = true;
+        setStatus(QString("Export #%1: waiting for FFmpeg...").arg(m_captureJob->id));
+        return;
+    }
 
-        // Save frame with sequential numbering for FFmpeg
-        QString frameFileName = QString("%1/frame_%2.png")
-                                    .arg(m_tempDir)
-                                    .arg(m_currentFrame, 6, 10, QChar('0'));
+    // Next frame as soon as control is back in the event loop
+    m_captureTimer->start(0);
+}
 
-        if (!frame.save(frameFileName, "PNG")) {
-            qDebug() << "Failed to save frame" << frameIndex;
-            setStatus("Error: Failed to save frame " + QString::number(frameIndex));
-            stopExport();
-            return;
-        }
+void AnimationExporter::onEncoderDrained(ExportJob *job)
+{
+    if (job != m_captureJob || !m_waitingForEncoder) return;
+    if (job->process->bytesToWrite() > encoderBufferLimit()) return;
 
-        m_capturedFrames.append(frameFileName);
-        qDebug() << "Captured frame" << frameIndex << "as" << frameFileName;
-    });
+    m_waitingForEncoder = false;
+    m_captureTimer->start(0);
 }
 
-QQuickItem* AnimationExporter::findTimelineItem(QQuickItem* parent)
+qint64 AnimationExporter::encoderBufferLimit() const
 {
-    if (!parent) return nullptr;
+    return qint64(m_yuvBuffer.size()) * MaxQueuedFrames;
+}
 
-    // Проверяем текущий элемент
-    QString objectName = parent->objectName();
-    if (objectName.contains("timeline", Qt::CaseInsensitive) ||
-        objectName.contains("TimeLineView", Qt::CaseInsensitive)) {
-        return parent;
+bool AnimationExporter::writeFrame(const QImage &frame)
+{
+    QProcess *process = m_captureJob ? m_captureJob->process : nullptr;
+    if (!process || process->state() != QProcess::Running) {
+        return false;
     }
 
-    // Проверяем по типу
-    QString className = parent->metaObject()->className();
-    if (className.contains("TimeLineView")) {
-        return parent;
+    // Already RGBA8888 when grabbed through the RHI, otherwise one QImage conversion
+    QImage rgba = frame.convertToFormat(QImage::Format_RGBA8888);
+    if (rgba.width() != m_renderWidth || rgba.height() != m_renderHeight) {
+        rgba = rgba.scaled(m_renderWidth, m_renderHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     }
 
-    // Рекурсивно ищем в детях
-    const auto children = parent->childItems();
-    for (QQuickItem* child : children) {
-        QQuickItem* result = findTimelineItem(child);
-        if (result) return result;
-    }
+    YuvConverter::rgbaToYuv420(rgba.constBits(), rgba.width(), rgba.height(), rgba.bytesPerLine(),
+                               reinterpret_cast<uchar *>(m_yuvBuffer.data()));
 
-    return nullptr;
+    return process->write(m_yuvBuffer) == m_yuvBuffer.size();
 }
 
-void AnimationExporter::loadKeyframe(int frameIndex)
+void AnimationExporter::loadKeyframe(const QVariant &keyframeData)
 {
     if (!m_keyframeManager) return;
 
+    const int frameIndex = keyframeData.toMap().value("frame").toInt();
     qDebug() << "Loading keyframe for frame" << frameIndex;
 
-    // Load keyframe using the keyframe manager
-    bool success = QMetaObject::invokeMethod(m_keyframeManager, "loadKeyframe",
-                                             Q_ARG(QVariant, frameIndex));
+    // Apply the job's snapshot rather than whatever the manager holds now
+    bool success = QMetaObject::invokeMethod(m_keyframeManager, "applyKeyframeData",
+                                             Q_ARG(QVariant, keyframeData));
 
     if (!success) {
         qDebug() << "Failed to load keyframe" << frameIndex;
     }
 }
 
-QImage AnimationExporter::captureView3D()
+void AnimationExporter::generateVideo()
 {
-    if (!m_view3d) {
-        qDebug() << "No view3d object available";
-        return QImage();
-    }
-
-    // Try to get the QQuickItem from the view3d object
-    QQuickItem *view3dItem = qobject_cast<QQuickItem*>(m_view3d);
-    if (!view3dItem) {
-        qDebug() << "view3d is not a QQuickItem";
-        return QImage();
-    }
+    ExportJob *job = m_captureJob;
+    if (!job) return;
 
-    // Get the window
-    QQuickWindow *window = view3dItem->window();
-    if (!window) {
-        qDebug() << "No window found for view3d";
-        return QImage();
+    if (job->capturedFrames == 0) {
+        // Encoder was started up front, nothing to encode now
+        finishJob(job, ExportJob::Failed, "No frames were captured");
+        return;
     }
 
-    // ИСПРАВЛЕНО: Получаем правильные координаты View3D в окне
-    QRectF view3dBounds = view3dItem->boundingRect();
-
-    // Используем mapRectToScene для получения правильной позиции
-    QRectF sceneRect = view3dItem->mapRectToScene(view3dBounds);
+    // All frames are already in the pipe, EOF lets FFmpeg finish encoding
+    // while the next queued job starts capturing
+    qDebug() << "Closing FFmpeg input for job" << job->id << "after" << job->capturedFrames << "frames";
+    job->state = ExportJob::Encoding;
+    job->process->closeWriteChannel();
 
-    // Преобразуем в координаты окна
-    QRect captureRect(
-        static_cast<int>(sceneRect.x()),
-        static_cast<int>(sceneRect.y()),
-        static_cast<int>(sceneRect.width()),
-        static_cast<int>(sceneRect.height())
-        );
+    m_captureJob = nullptr;
+    releaseView();
 
-    qDebug() << "View3D bounds:" << view3dBounds;
-    qDebug() << "View3D scene rect:" << sceneRect;
-    qDebug() << "Capture rect:" << captureRect;
-    qDebug() << "Window size:" << window->size();
+    setStatus(QString("Export #%1: generating video...").arg(job->id));
+    emit jobsChanged();
+    scheduleJobs();
+}
 
-    // Захватываем всё окно
-    QImage windowImage = window->grabWindow();
-    if (windowImage.isNull()) {
-        qDebug() << "Failed to grab window";
-        return QImage();
+void AnimationExporter::onFFmpegFinished(ExportJob *job, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    qDebug() << "FFmpeg for job" << job->id << "finished with exit code:" << exitCode << "status:" << exitStatus;
+
+    // Already reported by whoever ended the job, only release the process
+    if (!job->isDone()) {
+        if (job->state == ExportJob::Encoding && exitStatus == QProcess::NormalExit && exitCode == 0) {
+            finishJob(job, ExportJob::Finished, "Animation exported to: " + job->outputPath);
+        } else {
+            QString error = job->process->readAllStandardError();
+            qDebug() << "FFmpeg error output:" << error;
+            finishJob(job, ExportJob::Failed, "FFmpeg failed with exit code " + QString::number(exitCode) + "\n" + error);
+        }
     }
 
-    qDebug() << "Window image size:" << windowImage.size();
+    if (job->process) {
+        job->process->deleteLater();
+        job->process = nullptr;
+    }
+}
 
-    // ИСПРАВЛЕНО: Более точное определение области захвата
-    // Убеждаемся что область захвата в пределах окна
-    QRect windowRect(0, 0, windowImage.width(), windowImage.height());
-    captureRect = captureRect.intersected(windowRect);
+void AnimationExporter::onFFmpegError(ExportJob *job, QProcess::ProcessError error)
+{
+    qDebug() << "FFmpeg process error for job" << job->id << ":" << error;
 
-    // ИСПРАВЛЕНО: Добавляем проверку на разумность размеров
-    if (captureRect.isEmpty() || captureRect.width() < 50 || captureRect.height() < 50) {
-        qDebug() << "Capture rect is too small or empty:" << captureRect;
-        qDebug() << "Falling back to window center crop";
+    if (job->isDone()) return;
 
-        // Fallback: берем центральную часть окна, исключая верх и низ (где UI)
-        int margin = 60; // Отступ для UI элементов
-        captureRect = QRect(
-            0,
-            margin,
-            windowImage.width(),
-            windowImage.height() - margin * 2
-            );
+    QString errorString;
+    switch (error) {
+    case QProcess::FailedToStart:
+        errorString = "Failed to start FFmpeg process";
+        break;
+    case QProcess::Crashed:
+        errorString = "FFmpeg process crashed";
+        break;
+    case QProcess::Timedout:
+        errorString = "FFmpeg process timed out";
+        break;
+    case QProcess::WriteError:
+        // Reported through writeFrame(), FFmpeg's exit status tells the reason
+        return;
+    default:
+        errorString = "Unknown FFmpeg process error";
+        break;
     }
 
-    qDebug() << "Final capture rect:" << captureRect;
+    finishJob(job, ExportJob::Failed, errorString);
 
-    // Извлекаем только область View3D
-    QImage view3dImage = windowImage.copy(captureRect);
-    if (view3dImage.isNull()) {
-        qDebug() << "Failed to extract view3d area";
-        return windowImage; // Return full window if extraction fails
+    // A process that never started won't report finished()
+    if (error == QProcess::FailedToStart && job->process) {
+        job->process->deleteLater();
+        job->process = nullptr;
     }
-
-    qDebug() << "Extracted image size:" << view3dImage.size();
-
-    // Масштабируем до желаемого разрешения
-    QImage scaledImage = view3dImage.scaled(m_renderWidth, m_renderHeight,
-                                            Qt::IgnoreAspectRatio,
-                                            Qt::SmoothTransformation);
-
-    qDebug() << "Final scaled image size:" << scaledImage.size();
-
-    return scaledImage;
 }
 
-void AnimationExporter::generateVideo()
+void AnimationExporter::finishJob(ExportJob *job, ExportJob::State state, const QString &message)
 {
-    if (m_capturedFrames.isEmpty()) {
-        setStatus("Error: No frames captured");
-        emit exportCompleted(false, "No frames were captured");
-        m_isExporting = false;
-        emit isExportingChanged();
-        return;
-    }
+    job->state = state;
+    job->message = message;
 
-    setStatus("Generating video...");
-
-    QString ffmpegPath = getFFmpegPath();
-    QString inputPattern = QDir::toNativeSeparators(m_tempDir + "/frame_%06d.png");
+    if (m_captureJob == job) {
+        m_captureTimer->stop();
+        m_captureJob = nullptr;
+        releaseView();
+    }
 
-    // ИСПРАВЛЕНО: Убеждаемся что выходной путь правильный
-    QString outputPath = QDir::toNativeSeparators(m_exportPath);
+    // kill() doesn't block; the process is released when it reports finished()
+    if (job->process && job->process->state() != QProcess::NotRunning) {
+        job->process->kill();
+    }
 
-    // ИСПРАВЛЕНО: Создаем папку для выходного файла если она не существует
-    QFileInfo outputInfo(outputPath);
-    QDir outputDir = outputInfo.dir();
-    if (!outputDir.exists()) {
-        outputDir.mkpath(".");
-        qDebug() << "Created output directory:" << outputDir.absolutePath();
+    switch (state) {
+    case ExportJob::Finished:
+        setStatus(QString("Export #%1 completed successfully!").arg(job->id));
+        break;
+    case ExportJob::Cancelled:
+        setStatus(QString("Export #%1 cancelled").arg(job->id));
+        break;
+    default:
+        setStatus(QString("Export #%1 error: %2").arg(job->id).arg(message.section('\n', 0, 0)));
+        break;
     }
 
-    QStringList arguments;
-    arguments << "-y" // Overwrite output file
-              << "-framerate" << QString::number(m_frameRate)
-              << "-i" << inputPattern
-              << "-c:v" << "libx264"
-              << "-pix_fmt" << "yuv420p"
-              << "-preset" << "medium"
-              << "-crf" << "18" // High quality
-              << outputPath;
+    emit exportCompleted(state == ExportJob::Finished, message, job->id, jobStateName(state));
+    emit jobsChanged();
+    updateExportingState();
+    scheduleJobs();
+}
 
-    qDebug() << "Starting FFmpeg with arguments:" << arguments;
-    qDebug() << "Input pattern:" << inputPattern;
-    qDebug() << "Output path:" << outputPath;
+void AnimationExporter::releaseView()
+{
+    m_grab.reset();
+    m_waitingForEncoder = false;
 
-    m_ffmpegProcess->start(ffmpegPath, arguments);
+    // Whatever way the job ended, the user gets their scene back
+    if (m_keyframeManager && m_sceneState.isValid()) {
+        if (!QMetaObject::invokeMethod(m_keyframeManager, "restoreSceneState", Q_ARG(QVariant, m_sceneState))) {
+            qDebug() << "Failed to restore the scene state after export";
+        }
+    }
+    m_sceneState.clear();
+    m_keyframeManager = nullptr;
+    m_view3d = nullptr;
 
-    if (!m_ffmpegProcess->waitForStarted(5000)) {
-        setStatus("Error: Failed to start FFmpeg");
-        emit exportCompleted(false, "Failed to start FFmpeg process");
-        m_isExporting = false;
-        emit isExportingChanged();
-        cleanup();
+    if (m_viewportBusy) {
+        m_viewportBusy = false;
+        emit viewportBusyChanged();
+    }
+}
+
+ExportJob *AnimationExporter::findJob(int jobId) const
+{
+    for (ExportJob *job : m_jobs) {
+        if (job->id == jobId) return job;
     }
+    return nullptr;
 }
 
-void AnimationExporter::onFFmpegFinished(int exitCode, QProcess::ExitStatus exitStatus)
+QString AnimationExporter::availableOutputPath(const QString &path) const
 {
-    qDebug() << "FFmpeg finished with exit code:" << exitCode << "status:" << exitStatus;
+    // Two ffmpeg -y processes on one file would overwrite each other's output
+    auto inUse = [this](const QString &candidate) {
+        const QFileInfo candidateInfo(candidate);
+        for (const ExportJob *job : m_jobs) {
+            if (!job->isDone() && QFileInfo(job->outputPath) == candidateInfo) {
+                return true;
+            }
+        }
+        return false;
+    };
 
-    m_isExporting = false;
-    emit isExportingChanged();
+    if (!inUse(path)) return path;
 
-    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-        setStatus("Export completed successfully!");
-        emit exportCompleted(true, "Animation exported to: " + m_exportPath);
-    } else {
-        QString error = m_ffmpegProcess->readAllStandardError();
-        setStatus("Error: FFmpeg failed");
-        qDebug() << "FFmpeg error output:" << error;
-        emit exportCompleted(false, "FFmpeg failed with exit code " + QString::number(exitCode) + "\n" + error);
+    const QFileInfo info(path);
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    for (int n = 1;; ++n) {
+        const QString candidate = QDir(info.path()).filePath(QString("%1_%2%3").arg(info.completeBaseName()).arg(n).arg(suffix));
+        if (!inUse(candidate)) {
+            return QDir::toNativeSeparators(candidate);
+        }
     }
+}
 
-    cleanup();
+int AnimationExporter::runningEncoders() const
+{
+    return int(std::count_if(m_jobs.cbegin(), m_jobs.cend(),
+                             [](const ExportJob *job) { return job->isActive(); }));
 }
 
-void AnimationExporter::onFFmpegError(QProcess::ProcessError error)
+void AnimationExporter::updateExportingState()
 {
-    qDebug() << "FFmpeg process error:" << error;
+    const bool exporting = std::any_of(m_jobs.cbegin(), m_jobs.cend(),
+                                       [](const ExportJob *job) { return !job->isDone(); });
+    if (m_isExporting == exporting) return;
 
-    m_isExporting = false;
+    m_isExporting = exporting;
     emit isExportingChanged();
 
-    QString errorString;
-    switch (error) {
-    case QProcess::FailedToStart:
-        errorString = "Failed to start FFmpeg process";
-        break;
-    case QProcess::Crashed:
-        errorString = "FFmpeg process crashed";
-        break;
-    case QProcess::Timedout:
-        errorString = "FFmpeg process timed out";
-        break;
-    default:
-        errorString = "Unknown FFmpeg process error";
-        break;
+    if (!m_isExporting) {
+        cleanup();
     }
-
-    setStatus("Error: " + errorString);
-    emit exportCompleted(false, errorString);
-
-    cleanup();
 }
 
 void AnimationExporter::cleanup()
 {
-    // Clean up temporary files
-    if (!m_tempDir.isEmpty()) {
-        QDir tempDir(m_tempDir);
-        if (tempDir.exists()) {
-            tempDir.removeRecursively();
-            qDebug() << "Cleaned up temp directory:" << m_tempDir;
-        }
-    }
-
-    m_capturedFrames.clear();
+    m_yuvBuffer.clear();
 
     // Clean up OpenGL resources
     if (m_fbo) {
@@ -5,6 +5,7 @@
 #include <QProcess>
 #include <QTimer>
 #include <QQuickItem>
+#include <QQuickItemGrabResult>
 #include <QQuickWindow>
 #include <QQuickRenderControl>
 #include <QOpenGLFramebufferObject>
@@ -17,6 +18,51 @@
 #include <QDebug>
 #include <QImage>
 #include <QGuiApplication>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include "motionimporter.h"
+
+// One queued export: its own keyframe snapshot, settings and FFmpeg process
+struct ExportJob
+{
+    enum State {
+        Queued,
+        Starting,   // FFmpeg launched, waiting for it to come up
+        Capturing,  // Frames are rendered and piped to FFmpeg
+        Encoding,   // All frames sent, FFmpeg finishing the file
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    int id = 0;
+    State state = Queued;
+    QVector<int> frames;        // Timeline frames to capture, sorted
+    QHash<int, QVariant> keyframes; // KeyFrameManager.getKeyframe() data by frame
+
+    // Imported take on frames [motionStart, motionStart + motionFrames),
+    // its bones are sampled for each captured frame
+    QSharedPointer<const MotionClip> motion;
+    int motionStart = 0;
+    int motionFrames = 0;
+    QVariantMap motionRestPose;
+
+    QPointer<QObject> keyframeManager;
+    QPointer<QObject> view3d;
+    QString outputPath;
+    int width = 1920;
+    int height = 1080;
+    int frameRate = 24;
+    int capturedFrames = 0;
+    QString message;
+    QProcess *process = nullptr;
+
+    bool isActive() const { return state == Starting || state == Capturing || state == Encoding; }
+    bool isDone() const { return state == Finished || state == Failed || state == Cancelled; }
+};
 
 class AnimationExporter : public QObject
 {
@@ -27,6 +73,9 @@ class AnimationExporter : public QObject
     Q_PROPERTY(QString exportPath READ exportPath WRITE setExportPath NOTIFY exportPathChanged)
     Q_PROPERTY(int frameRate READ frameRate WRITE setFrameRate NOTIFY frameRateChanged)
     Q_PROPERTY(QString status READ status NOTIFY statusChanged)
+    Q_PROPERTY(QVariantList jobs READ jobs NOTIFY jobsChanged)
+    Q_PROPERTY(int maxConcurrentEncodes READ maxConcurrentEncodes WRITE setMaxConcurrentEncodes NOTIFY maxConcurrentEncodesChanged)
+    Q_PROPERTY(bool viewportBusy READ viewportBusy NOTIFY viewportBusyChanged) // A job is driving the live scene
 
 public:
     explicit AnimationExporter(QObject *parent = nullptr);
@@ -39,11 +88,20 @@ public:
     QString exportPath() const { return m_exportPath; }
     int frameRate() const { return m_frameRate; }
     QString status() const { return m_status; }
+    QVariantList jobs() const;
+    int maxConcurrentEncodes() const { return m_maxConcurrentEncodes; }
+    bool viewportBusy() const { return m_viewportBusy; }
 
     void setExportPath(const QString &path);
     void setFrameRate(int rate);
+    void setMaxConcurrentEncodes(int count);
 
 public slots:
+    // Queues an export of the current keyframes with the current settings, returns the job id
+    int enqueueExport(QObject *keyframeManager, QObject *view3d, int width = 1920, int height = 1080);
+    void cancelJob(int jobId);
+    void clearFinishedJobs();
+
     void startExport(QObject *keyframeManager, QObject *view3d, int width = 1920, int height = 1080);
     void stopExport();
     bool checkFFmpegAvailable();
@@ -55,26 +113,41 @@ signals:
     void exportPathChanged();
     void frameRateChanged();
     void statusChanged();
-    void exportCompleted(bool success, const QString &message);
+    void jobsChanged();
+    void maxConcurrentEncodesChanged();
+    void viewportBusyChanged();
+    // state: "finished", "failed" or "cancelled"
+    void exportCompleted(bool success, const QString &message, int jobId, const QString &state);
     void exportProgress(int frame, int total, const QString &status);
 
 private slots:
     void captureNextFrame();
-    void onFFmpegFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onFFmpegError(QProcess::ProcessError error);
 
 private:
-    void setupDirectories();
+    void scheduleJobs();
+    void startEncoder(ExportJob *job);
+    void beginCapture(ExportJob *job);
+    void onFFmpegFinished(ExportJob *job, int exitCode, QProcess::ExitStatus exitStatus);
+    void onFFmpegError(ExportJob *job, QProcess::ProcessError error);
+    void finishJob(ExportJob *job, ExportJob::State state, const QString &message);
+    ExportJob *findJob(int jobId) const;
+    QString availableOutputPath(const QString &path) const;
+    int runningEncoders() const;
+    void updateExportingState();
+
+    void releaseView();
     void captureFrame(int frameIndex);
-    QQuickItem* findTimelineItem(QQuickItem* parent);
-    void loadKeyframe(int frameIndex);
+    void frameGrabbed(int frameIndex);
+    void onEncoderDrained(ExportJob *job);
+    qint64 encoderBufferLimit() const;
+    bool writeFrame(const QImage &frame);
+    void loadKeyframe(const QVariant &keyframeData);
     void generateVideo();
     void cleanup();
     void setStatus(const QString &status);
     QString getFFmpegPath();
-    QImage captureView3D();
 
-    // Core objects
+    // Core objects of the job being captured
     QObject *m_keyframeManager;
     QObject *m_view3d;
 
@@ -90,14 +163,23 @@ private:
     int m_renderWidth;
     int m_renderHeight;
 
-    // Frame capture
+    // Job queue. Capturing drives the live scene, so only one job captures at
+    // a time; up to m_maxConcurrentEncodes FFmpeg processes run side by side.
+    QList<ExportJob *> m_jobs;
+    ExportJob *m_captureJob;
+    int m_nextJobId;
+    int m_maxConcurrentEncodes;
+
+    // Frame capture. The scene state the user had is saved while a job drives
+    // the view and restored when the job stops capturing.
     QTimer *m_captureTimer;
-    QStringList m_keyframes;
-    QString m_tempDir;
-    QStringList m_capturedFrames;
+    QSharedPointer<QQuickItemGrabResult> m_grab;
+    QVariant m_sceneState;
+    bool m_viewportBusy;
+    bool m_waitingForEncoder;   // Capture paused until FFmpeg reads its backlog
 
-    // FFmpeg process
-    QProcess *m_ffmpegProcess;
+    // Reused YUV420 frame buffer piped to FFmpeg
+    QByteArray m_yuvBuffer;
 
     // Rendering context
     QOpenGLContext *m_context;
@@ -0,0 +1,311 @@
+#include "bonepicker.h"
+#include "boneutils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int LeafSize = 4;
+constexpr int MaxTreeDepth = 64;
+
+inline QVector3D componentMin(const QVector3D &a, const QVector3D &b)
+{
+    return QVector3D(std::min(a.x(), b.x()), std::min(a.y(), b.y()), std::min(a.z(), b.z()));
+}
+
+inline QVector3D componentMax(const QVector3D &a, const QVector3D &b)
+{
+    return QVector3D(std::max(a.x(), b.x()), std::max(a.y(), b.y()), std::max(a.z(), b.z()));
+}
+
+// Slab test, returns the entry distance or a negative value on a miss
+inline float rayBoxEntry(const QVector3D &origin, const QVector3D &inverseDirection,
+                         const QVector3D &min, const QVector3D &max)
+{
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        float t0 = (min[axis] - origin[axis]) * inverseDirection[axis];
+        float t1 = (max[axis] - origin[axis]) * inverseDirection[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) return -1.0f;
+    }
+    return tMin;
+}
+
+// Closest approach between a ray (unit direction) and the segment a-b.
+// Returns the squared distance and the ray parameter at that point.
+inline float raySegmentDistance(const QVector3D &origin, const QVector3D &direction,
+                                const QVector3D &a, const QVector3D &b, float &rayT)
+{
+    const QVector3D u = b - a;
+    const QVector3D w = a - origin;
+    const float uu = QVector3D::dotProduct(u, u);
+    const float ud = QVector3D::dotProduct(u, direction);
+    const float uw = QVector3D::dotProduct(u, w);
+    const float dw = QVector3D::dotProduct(direction, w);
+
+    float s = 0.0f;
+    if (uu > 1e-12f) {
+        const float denominator = uu - ud * ud;
+        s = denominator > 1e-12f ? std::clamp((ud * dw - uw) / denominator, 0.0f, 1.0f) : 0.0f;
+    }
+
+    float t = dw + s * ud;
+    if (t < 0.0f) {
+        t = 0.0f;
+        s = uu > 1e-12f ? std::clamp(-uw / uu, 0.0f, 1.0f) : 0.0f;
+    }
+
+    rayT = t;
+    return (w + u * s - direction * t).lengthSquared();
+}
+
+} // namespace
+
+BonePicker::BonePicker(QObject *parent)
+    : QObject(parent)
+    , m_pickRadius(0.0)
+    , m_autoRadius(1.0f)
+    , m_dirty(false)
+{
+}
+
+void BonePicker::setPickRadius(double radius)
+{
+    if (m_pickRadius != radius && radius >= 0.0) {
+        m_pickRadius = radius;
+        m_dirty = true;
+        emit pickRadiusChanged();
+    }
+}
+
+void BonePicker::setBones(const QVariantList &nodes, const QVariantList &bones)
+{
+    clear();
+
+    // bonesList is in traversal order
+    QVector<int> parentSlots;
+    BoneParentTracker parents;
+
+    for (const QVariant &entry : bones) {
+        const QVariantMap boneData = entry.toMap();
+        const int index = boneData.value("index").toInt();
+        const int level = boneData.value("level").toInt();
+
+        m_listPosition.insert(index, m_listPosition.size());
+        m_nameIndex.insert(boneData.value("name").toString(), index);
+
+        QObject *node = index >= 0 && index < nodes.size() ? nodes.at(index).value<QObject *>() : nullptr;
+        if (!node) continue;
+
+        const QMetaObject *meta = node->metaObject();
+        const int property = meta->indexOfProperty("scenePosition");
+        if (property < 0) continue;
+
+        const int slot = m_bones.size();
+        m_bones.append({ node, meta->property(property), QVector3D() });
+        m_boneIndices.append(index);
+        parentSlots.append(parents.push(level, slot));
+    }
+
+    // Segments from each bone to its child bones, point capsules for leaves
+    QVector<bool> hasChildren(m_bones.size(), false);
+    for (int slot = 0; slot < m_bones.size(); ++slot) {
+        if (parentSlots[slot] >= 0) {
+            m_capsules.append({ parentSlots[slot], slot });
+            hasChildren[parentSlots[slot]] = true;
+        }
+    }
+    for (int slot = 0; slot < m_bones.size(); ++slot) {
+        if (!hasChildren[slot]) {
+            m_capsules.append({ slot, slot });
+        }
+    }
+
+    readPositions();
+
+    // Default pick radius follows the rig's scale
+    float totalLength = 0.0f;
+    int segments = 0;
+    for (const Capsule &capsule : std::as_const(m_capsules)) {
+        const float length = (m_bones[capsule.to].position - m_bones[capsule.from].position).length();
+        if (length > 0.0f) {
+            totalLength += length;
+            ++segments;
+        }
+    }
+    m_autoRadius = segments > 0 ? 0.15f * totalLength / segments : 1.0f;
+
+    build();
+
+    qDebug() << "BonePicker: indexed" << m_bones.size() << "bones," << m_capsules.size()
+             << "segments," << m_tree.size() << "tree nodes";
+    emit bonesChanged();
+}
+
+void BonePicker::clear()
+{
+    const bool hadBones = !m_bones.isEmpty();
+
+    m_bones.clear();
+    m_boneIndices.clear();
+    m_capsules.clear();
+    m_tree.clear();
+    m_nameIndex.clear();
+    m_listPosition.clear();
+    m_dirty = false;
+
+    if (hadBones) {
+        emit bonesChanged();
+    }
+}
+
+int BonePicker::pick(const QVector3D &origin, const QVector3D &direction)
+{
+    if (m_tree.isEmpty() || direction.isNull()) {
+        return -1;
+    }
+
+    if (m_dirty) {
+        refit();
+    }
+
+    const QVector3D dir = direction.normalized();
+    const QVector3D inverseDirection(1.0f / dir.x(), 1.0f / dir.y(), 1.0f / dir.z());
+    const float radius = effectiveRadius();
+    const float radiusSquared = radius * radius;
+
+    float bestT = std::numeric_limits<float>::max();
+    int bestSlot = -1;
+
+    int stack[MaxTreeDepth];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const TreeNode &node = m_tree[stack[--stackSize]];
+        const float entry = rayBoxEntry(origin, inverseDirection, node.box.min, node.box.max);
+        if (entry < 0.0f || entry > bestT) continue;
+
+        if (node.count == 0) {
+            if (stackSize + 2 > MaxTreeDepth) continue;
+            stack[stackSize++] = node.first + 1;
+            stack[stackSize++] = node.first;
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            const Capsule &capsule = m_capsules[i];
+            float t = 0.0f;
+            const float distance = raySegmentDistance(origin, dir, m_bones[capsule.from].position,
+                                                      m_bones[capsule.to].position, t);
+            if (distance <= radiusSquared && t < bestT) {
+                bestT = t;
+                bestSlot = capsule.from;
+            }
+        }
+    }
+
+    return bestSlot >= 0 ? m_boneIndices[bestSlot] : -1;
+}
+
+void BonePicker::readPositions()
+{
+    for (Bone &bone : m_bones) {
+        if (bone.node) {
+            bone.position = bone.scenePosition.read(bone.node).value<QVector3D>();
+        }
+    }
+}
+
+BonePicker::Box BonePicker::capsuleBox(const Capsule &capsule) const
+{
+    const QVector3D a = m_bones[capsule.from].position;
+    const QVector3D b = m_bones[capsule.to].position;
+    const QVector3D r(effectiveRadius(), effectiveRadius(), effectiveRadius());
+    return { componentMin(a, b) - r, componentMax(a, b) + r };
+}
+
+float BonePicker::effectiveRadius() const
+{
+    return m_pickRadius > 0.0 ? float(m_pickRadius) : m_autoRadius;
+}
+
+void BonePicker::build()
+{
+    m_tree.clear();
+    if (m_capsules.isEmpty()) return;
+
+    m_tree.reserve(2 * (m_capsules.size() / LeafSize + 1));
+    m_tree.append(TreeNode());
+    buildRange(0, 0, m_capsules.size());
+    m_dirty = false;
+}
+
+void BonePicker::buildRange(int nodeIndex, int begin, int end)
+{
+    Box bounds = capsuleBox(m_capsules[begin]);
+    Box centroids{ bounds.min + bounds.max, bounds.min + bounds.max };
+    for (int i = begin + 1; i < end; ++i) {
+        const Box box = capsuleBox(m_capsules[i]);
+        bounds.min = componentMin(bounds.min, box.min);
+        bounds.max = componentMax(bounds.max, box.max);
+        centroids.min = componentMin(centroids.min, box.min + box.max);
+        centroids.max = componentMax(centroids.max, box.min + box.max);
+    }
+
+    if (end - begin <= LeafSize) {
+        m_tree[nodeIndex] = { bounds, begin, end - begin };
+        return;
+    }
+
+    // Median split along the longest axis of the centroid bounds
+    const QVector3D extent = centroids.max - centroids.min;
+    const int axis = extent.x() > extent.y() ? (extent.x() > extent.z() ? 0 : 2)
+                                             : (extent.y() > extent.z() ? 1 : 2);
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(m_capsules.begin() + begin, m_capsules.begin() + middle, m_capsules.begin() + end,
+                     [this, axis](const Capsule &a, const Capsule &b) {
+                         const Box boxA = capsuleBox(a);
+                         const Box boxB = capsuleBox(b);
+                         return boxA.min[axis] + boxA.max[axis] < boxB.min[axis] + boxB.max[axis];
+                     });
+
+    const int left = m_tree.size();
+    m_tree.append(TreeNode());
+    m_tree.append(TreeNode());
+    m_tree[nodeIndex] = { bounds, left, 0 };
+
+    buildRange(left, begin, middle);
+    buildRange(left + 1, middle, end);
+}
+
+void BonePicker::refit()
+{
+    // Topology stays the same, only the boxes follow the new pose.
+    // Children are always stored after their parent, so one reverse pass suffices.
+    readPositions();
+
+    for (int i = m_tree.size() - 1; i >= 0; --i) {
+        TreeNode &node = m_tree[i];
+        if (node.count > 0) {
+            Box box = capsuleBox(m_capsules[node.first]);
+            for (int c = node.first + 1; c < node.first + node.count; ++c) {
+                const Box capsule = capsuleBox(m_capsules[c]);
+                box.min = componentMin(box.min, capsule.min);
+                box.max = componentMax(box.max, capsule.max);
+            }
+            node.box = box;
+        } else {
+            const Box &left = m_tree[node.first].box;
+            const Box &right = m_tree[node.first + 1].box;
+            node.box = { componentMin(left.min, right.min), componentMax(left.max, right.max) };
+        }
+    }
+
+    m_dirty = false;
+}
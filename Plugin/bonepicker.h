@@ -0,0 +1,97 @@
+#ifndef BONEPICKER_H
+#define BONEPICKER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QMetaProperty>
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+#include <QVariant>
+#include <QDebug>
+
+// Ray picking of bones in the viewport. Every bone contributes capsules
+// along the segments to its child bones (a point capsule for leaf bones),
+// kept in a bounding volume hierarchy over the bones' scene positions.
+// Pose changes only mark the hierarchy dirty; it is refitted on the next
+// pick instead of being rebuilt.
+class BonePicker : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int boneCount READ boneCount NOTIFY bonesChanged)
+    Q_PROPERTY(double pickRadius READ pickRadius WRITE setPickRadius NOTIFY pickRadiusChanged)
+
+public:
+    explicit BonePicker(QObject *parent = nullptr);
+
+    // Properties
+    int boneCount() const { return m_bones.size(); }
+    double pickRadius() const { return m_pickRadius; }
+    void setPickRadius(double radius);
+
+    // nodes: BoneManipulator.modelNodes, bones: BoneManipulator.bonesList
+    Q_INVOKABLE void setBones(const QVariantList &nodes, const QVariantList &bones);
+    Q_INVOKABLE void clear();
+
+    // Bone positions changed, refit before the next pick
+    Q_INVOKABLE void markDirty() { m_dirty = true; }
+
+    // Returns the bone (modelNodes index) closest along the ray, or -1
+    Q_INVOKABLE int pick(const QVector3D &origin, const QVector3D &direction);
+
+    // Hash lookups, -1 if unknown
+    Q_INVOKABLE int boneIndexForName(const QString &name) const { return m_nameIndex.value(name, -1); }
+    Q_INVOKABLE int listPosition(int boneIndex) const { return m_listPosition.value(boneIndex, -1); }
+
+signals:
+    void bonesChanged();
+    void pickRadiusChanged();
+
+private:
+    struct Bone
+    {
+        QPointer<QObject> node;
+        QMetaProperty scenePosition;
+        QVector3D position;
+    };
+
+    struct Capsule
+    {
+        int from;   // Bone the segment starts at and that is picked
+        int to;     // Child bone, same as from for leaf bones
+    };
+
+    struct Box
+    {
+        QVector3D min;
+        QVector3D max;
+    };
+
+    struct TreeNode
+    {
+        Box box;
+        int first;  // Inner node: index of left child (right is first + 1), leaf: first capsule
+        int count;  // 0 for inner nodes
+    };
+
+    void readPositions();
+    void build();
+    void buildRange(int nodeIndex, int begin, int end);
+    void refit();
+    Box capsuleBox(const Capsule &capsule) const;
+    float effectiveRadius() const;
+
+    QVector<Bone> m_bones;
+    QVector<int> m_boneIndices;         // Bone slot -> modelNodes index
+    QVector<Capsule> m_capsules;
+    QVector<TreeNode> m_tree;
+
+    QHash<QString, int> m_nameIndex;    // Bone name -> modelNodes index
+    QHash<int, int> m_listPosition;     // modelNodes index -> position in bonesList
+
+    double m_pickRadius;
+    float m_autoRadius;
+    bool m_dirty;
+};
+
+#endif // BONEPICKER_H
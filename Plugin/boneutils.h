@@ -0,0 +1,54 @@
+#ifndef BONEUTILS_H
+#define BONEUTILS_H
+
+#include <QVariant>
+#include <QVector>
+#include <QVector3D>
+#include <QPair>
+
+// Helpers shared by the C++ side of the plugin for the QML bone data:
+// { x, y, z } maps as used in BoneManipulator.boneTransforms and keyframes,
+// and the level-based bone lists of BoneManipulator.bonesList.
+
+inline QVariantMap vectorMap(const QVector3D &v)
+{
+    return QVariantMap{ { "x", v.x() }, { "y", v.y() }, { "z", v.z() } };
+}
+
+inline QVector3D mapVector(const QVariant &value, const QVector3D &fallback)
+{
+    const QVariantMap map = value.toMap();
+    if (map.isEmpty()) return fallback;
+    return QVector3D(map.value("x").toFloat(), map.value("y").toFloat(), map.value("z").toFloat());
+}
+
+// Per-component a / b for scale factors; a zero divisor gives 1 (no scaling)
+inline QVector3D safeDivide(const QVector3D &a, const QVector3D &b)
+{
+    return QVector3D(b.x() != 0.0f ? a.x() / b.x() : 1.0f,
+                     b.y() != 0.0f ? a.y() / b.y() : 1.0f,
+                     b.z() != 0.0f ? a.z() / b.z() : 1.0f);
+}
+
+// Parents for a bone list in traversal order: the parent of a bone is the
+// closest preceding bone on a lower level. Feed the bones in list order;
+// push() returns the parent's slot, or -1 for a root.
+class BoneParentTracker
+{
+public:
+    int push(int level, int slot)
+    {
+        while (!m_open.isEmpty() && m_open.last().first >= level) {
+            m_open.removeLast();
+        }
+
+        const int parent = m_open.isEmpty() ? -1 : m_open.last().second;
+        m_open.append(qMakePair(level, slot));
+        return parent;
+    }
+
+private:
+    QVector<QPair<int, int>> m_open; // (level, slot)
+};
+
+#endif // BONEUTILS_H
@@ -0,0 +1,197 @@
+#include "crowdinstancing.h"
+#include "boneutils.h"
+#include <QRandomGenerator>
+#include <QColor>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Below this, spreading the work over the pool costs more than it saves
+constexpr int ParallelThreshold = 512;
+constexpr int MinChunkSize = 256;
+
+} // namespace
+
+CrowdInstancing::CrowdInstancing(QQuick3DObject *parent)
+    : QQuick3DInstancing(parent)
+    , m_count(100)
+    , m_columns(0)
+    , m_spacing(150.0f)
+    , m_maxTimeOffset(0.0f)
+    , m_time(0.0f)
+    , m_instancesDirty(true)
+{
+    samplePhases();
+}
+
+float CrowdInstancing::trackLength() const
+{
+    return m_track.size() > 1 ? m_track.last().frame - m_track.first().frame : 0.0f;
+}
+
+void CrowdInstancing::setCount(int count)
+{
+    if (m_count != count && count >= 0) {
+        m_count = count;
+        samplePhases();
+        m_instancesDirty = true;
+        markDirty();
+        emit countChanged();
+    }
+}
+
+void CrowdInstancing::setColumns(int columns)
+{
+    if (m_columns != columns && columns >= 0) {
+        m_columns = columns;
+        m_instancesDirty = true;
+        markDirty();
+        emit columnsChanged();
+    }
+}
+
+void CrowdInstancing::setSpacing(float spacing)
+{
+    if (m_spacing != spacing) {
+        m_spacing = spacing;
+        m_instancesDirty = true;
+        markDirty();
+        emit spacingChanged();
+    }
+}
+
+void CrowdInstancing::setMaxTimeOffset(float frames)
+{
+    if (m_maxTimeOffset != frames && frames >= 0.0f) {
+        m_maxTimeOffset = frames;
+        m_instancesDirty = true;
+        markDirty();
+        emit maxTimeOffsetChanged();
+    }
+}
+
+void CrowdInstancing::setTime(float frame)
+{
+    if (m_time != frame) {
+        m_time = frame;
+        m_instancesDirty = true;
+        markDirty();
+        emit timeChanged();
+    }
+}
+
+void CrowdInstancing::setTrack(const QVariantList &keyframes)
+{
+    m_track.clear();
+    m_track.reserve(keyframes.size());
+
+    for (const QVariant &entry : keyframes) {
+        const QVariantMap keyframe = entry.toMap();
+        TrackKey key;
+        key.frame = keyframe.value("frame").toFloat();
+        key.position = mapVector(keyframe.value("position"), QVector3D());
+        key.rotation = QQuaternion::fromEulerAngles(mapVector(keyframe.value("rotation"), QVector3D()));
+        key.scale = mapVector(keyframe.value("scale"), QVector3D(1, 1, 1));
+        m_track.append(key);
+    }
+
+    std::sort(m_track.begin(), m_track.end(),
+              [](const TrackKey &a, const TrackKey &b) { return a.frame < b.frame; });
+
+    qDebug() << "CrowdInstancing: track with" << m_track.size() << "keyframes, length" << trackLength() << "frames";
+
+    m_instancesDirty = true;
+    markDirty();
+    emit trackChanged();
+}
+
+QByteArray CrowdInstancing::getInstanceBuffer(int *instanceCount)
+{
+    if (m_instancesDirty) {
+        updateInstances();
+    }
+
+    if (instanceCount) {
+        *instanceCount = m_count;
+    }
+    return m_instanceData;
+}
+
+void CrowdInstancing::updateInstances()
+{
+    m_instanceData.resize(qsizetype(m_count) * qsizetype(sizeof(InstanceTableEntry)));
+    InstanceTableEntry *entries = reinterpret_cast<InstanceTableEntry *>(m_instanceData.data());
+
+    if (m_count < ParallelThreshold) {
+        fillInstances(entries, 0, m_count);
+    } else {
+        // A few chunks per thread keeps the pool balanced
+        const int chunkSize = std::max(MinChunkSize, m_count / (m_pool.maxThreadCount() * 4));
+        for (int begin = 0; begin < m_count; begin += chunkSize) {
+            const int end = std::min(begin + chunkSize, m_count);
+            m_pool.start([this, entries, begin, end]() { fillInstances(entries, begin, end); });
+        }
+        m_pool.waitForDone();
+    }
+
+    m_instancesDirty = false;
+}
+
+void CrowdInstancing::fillInstances(InstanceTableEntry *entries, int begin, int end) const
+{
+    const int columns = m_columns > 0 ? m_columns : std::max(1, int(std::ceil(std::sqrt(double(m_count)))));
+    const int rows = (m_count + columns - 1) / columns;
+    const float originX = 0.5f * (columns - 1) * m_spacing;
+    const float originZ = 0.5f * (rows - 1) * m_spacing;
+
+    const float length = trackLength();
+    const bool animated = m_track.size() > 1 && length > 0.0f;
+
+    for (int i = begin; i < end; ++i) {
+        QVector3D position(i % columns * m_spacing - originX, 0.0f, i / columns * m_spacing - originZ);
+        QQuaternion rotation;
+        QVector3D scale(1, 1, 1);
+
+        if (!m_track.isEmpty()) {
+            // Absolute keyframed transform: the model node itself is pinned
+            // at the origin while crowd mode is on (KeyFrameManager.pinModelTransform)
+            const TrackKey &first = m_track.first();
+            TrackKey sample = first;
+
+            if (animated) {
+                const float local = std::fmod(m_time - first.frame + m_phases[i] * m_maxTimeOffset, length);
+                const float frame = first.frame + (local < 0.0f ? local + length : local);
+
+                auto next = std::upper_bound(m_track.cbegin(), m_track.cend(), frame,
+                                             [](float f, const TrackKey &key) { return f < key.frame; });
+                if (next == m_track.cend()) {
+                    sample = m_track.last();
+                } else {
+                    const TrackKey &b = *next;
+                    const TrackKey &a = *(next - 1);
+                    const float alpha = b.frame > a.frame ? (frame - a.frame) / (b.frame - a.frame) : 0.0f;
+                    sample.position = a.position + (b.position - a.position) * alpha;
+                    sample.rotation = QQuaternion::slerp(a.rotation, b.rotation, alpha);
+                    sample.scale = a.scale + (b.scale - a.scale) * alpha;
+                }
+            }
+
+            position += sample.position;
+            rotation = sample.rotation;
+            scale = sample.scale;
+        }
+
+        entries[i] = calculateTableEntryFromQuaternion(position, scale, rotation, Qt::white);
+    }
+}
+
+void CrowdInstancing::samplePhases()
+{
+    // Fixed seed: the same instance keeps its offset when the count changes
+    QRandomGenerator generator(0x4d50);
+    m_phases.resize(m_count);
+    for (float &phase : m_phases) {
+        phase = float(generator.generateDouble());
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CROWDINSTANCING_H
+#define CROWDINSTANCING_H
+
+#include <QtQuick3D/QQuick3DInstancing>
+#include <QThreadPool>
+#include <QVector>
+#include <QVector3D>
+#include <QQuaternion>
+#include <QVariant>
+#include <QDebug>
+
+// Instance table for crowd previews: count copies of the loaded model on a
+// grid, each playing the keyframed model transform with its own time offset.
+// The transforms are absolute, so the model node has to stay at the origin
+// while the table is attached (KeyFrameManager.pinModelTransform).
+// Instances are sampled in parallel into one packed buffer, so the renderer
+// issues one draw per mesh no matter how many characters there are.
+// All instances share the skeleton pose; only the transforms differ.
+class CrowdInstancing : public QQuick3DInstancing
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count WRITE setCount NOTIFY countChanged)
+    Q_PROPERTY(int columns READ columns WRITE setColumns NOTIFY columnsChanged)
+    Q_PROPERTY(float spacing READ spacing WRITE setSpacing NOTIFY spacingChanged)
+    Q_PROPERTY(float maxTimeOffset READ maxTimeOffset WRITE setMaxTimeOffset NOTIFY maxTimeOffsetChanged)
+    Q_PROPERTY(float time READ time WRITE setTime NOTIFY timeChanged) // Timeline frame, wraps over the track
+    Q_PROPERTY(float trackLength READ trackLength NOTIFY trackChanged)
+
+public:
+    explicit CrowdInstancing(QQuick3DObject *parent = nullptr);
+
+    // Properties
+    int count() const { return m_count; }
+    int columns() const { return m_columns; }
+    float spacing() const { return m_spacing; }
+    float maxTimeOffset() const { return m_maxTimeOffset; }
+    float time() const { return m_time; }
+    float trackLength() const;
+
+    void setCount(int count);
+    void setColumns(int columns);
+    void setSpacing(float spacing);
+    void setMaxTimeOffset(float frames);
+    void setTime(float frame);
+
+    // keyframes: KeyFrameManager.getModelTrack() ({ frame, position, rotation, scale } entries)
+    Q_INVOKABLE void setTrack(const QVariantList &keyframes);
+
+signals:
+    void countChanged();
+    void columnsChanged();
+    void spacingChanged();
+    void maxTimeOffsetChanged();
+    void timeChanged();
+    void trackChanged();
+
+protected:
+    QByteArray getInstanceBuffer(int *instanceCount) override;
+
+private:
+    struct TrackKey
+    {
+        float frame;
+        QVector3D position;
+        QQuaternion rotation;
+        QVector3D scale;
+    };
+
+    void updateInstances();
+    void fillInstances(InstanceTableEntry *entries, int begin, int end) const;
+    void samplePhases();
+
+    QVector<TrackKey> m_track;
+    QVector<float> m_phases;    // Per-instance offset in [0, 1) of maxTimeOffset
+
+    int m_count;
+    int m_columns;
+    float m_spacing;
+    float m_maxTimeOffset;
+    float m_time;
+
+    bool m_instancesDirty;
+    QByteArray m_instanceData;
+    QThreadPool m_pool;
+};
+
+#endif // CROWDINSTANCING_H
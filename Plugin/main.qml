@@ -30,6 +30,7 @@ Window {
 
     BoneControlWindow {
         id: boneControlWindow
+        sceneLocked: exportWindow.exporter.viewportBusy
     }
 
     PhysicsWindow {
@@ -45,6 +46,36 @@ Window {
         }
     }
 
+    CrowdWindow {
+        id: crowdWindow
+        keyframeManager: keyframeManager
+        sceneLocked: exportWindow.exporter.viewportBusy
+    }
+
+    PoseStreamWindow {
+        id: poseStreamWindow
+        boneManipulator: boneControlWindow.manipulator
+        keyframeManager: keyframeManager
+        timeline: timeline
+        timelineRate: exportWindow.exporter.frameRate
+        sceneLocked: exportWindow.exporter.viewportBusy
+    }
+
+    RetargetWindow {
+        id: retargetWindow
+        boneManipulator: boneControlWindow.manipulator
+        keyframeManager: keyframeManager
+        timeline: timeline
+        sceneLocked: exportWindow.exporter.viewportBusy
+    }
+
+    // Живой поток поз: новейшая поза применяется один раз за кадр.
+    // Пока экспорт захватывает сцену, позы копятся в кольце потока
+    FrameAnimation {
+        running: poseStreamWindow.stream.listening && !exportWindow.exporter.viewportBusy
+        onTriggered: poseStreamWindow.stream.applyLatest()
+    }
+
     ExportWindow {
         id: exportWindow
         keyframeManager: keyframeManager
@@ -77,6 +108,7 @@ Window {
         loadedModel: importNode
         directionalLight: directionalLight
         pointLight: pointLight
+        sceneLocked: exportWindow.exporter.viewportBusy
 
         onKeyframeSaved: function(frame, data) {
             console.log("✅ Keyframe saved for frame", frame + 1)
@@ -103,6 +135,10 @@ Window {
         boneManipulator: boneControlWindow.manipulator
         keyframeManager: keyframeManager
         physicsWindow: physicsWindow
+        crowdWindow: crowdWindow
+        poseStreamWindow: poseStreamWindow
+        retargetWindow: retargetWindow
+        sceneLocked: exportWindow.exporter.viewportBusy
 
         onOrbitModeRequested: cameraHelper.switchController(true)
         onWasdModeRequested: cameraHelper.switchController(false)
@@ -122,6 +158,31 @@ Window {
             console.log("✅ Keyframes exported to console")
         }
         onExportAnimationRequested: exportWindow.visible = !exportWindow.visible
+        onImportMotionRequested: motionFileDialog.open()
+        onToggleCrowdRequested: crowdWindow.visible = !crowdWindow.visible
+        onTogglePoseStreamRequested: poseStreamWindow.visible = !poseStreamWindow.visible
+        onToggleRetargetRequested: retargetWindow.visible = !retargetWindow.visible
+    }
+
+    MotionImporter {
+        id: motionImporter
+        // Дубль выбирается с частотой кадров таймлайна (видео)
+        sampleRate: exportWindow.exporter.frameRate
+
+        onImportCompleted: function(success, message) {
+            console.log(success ? "✅" : "❌", "Motion import:", message)
+            if (success) {
+                keyframeManager.setMotionTrack(motionImporter, timeline.currentFrame)
+                fitTimelineToMotion()
+                keyframeManager.loadKeyframe(timeline.currentFrame)
+            }
+        }
+
+        onTrackChanged: {
+            if (keyframeManager.motionTrack === motionImporter) {
+                fitTimelineToMotion()
+            }
+        }
     }
 
     View3D {
@@ -147,6 +208,8 @@ Window {
         RuntimeLoader {
             id: importNode
             source: windowRoot.importUrl
+            // Режим толпы: один draw call на меш для всех экземпляров
+            instancing: crowdWindow.crowdEnabled ? crowdWindow.instancing : null
             onBoundsChanged: cameraHelper.updateBounds(bounds)
             onStatusChanged: {
                 if (status === RuntimeLoader.Success) {
@@ -188,6 +251,20 @@ Window {
 
         camera: cameraHelper.orbitControllerEnabled ? orbitCamera : wasdCamera
 
+        // Выбор кости кликом: луч из камеры через точку клика
+        TapHandler {
+            acceptedButtons: Qt.LeftButton
+            enabled: boneControlWindow.manipulator.manipulationEnabled && !exportWindow.exporter.viewportBusy
+            onTapped: function(eventPoint) {
+                var nearPoint = view3D.mapTo3DScene(Qt.vector3d(eventPoint.position.x, eventPoint.position.y, 0))
+                var farPoint = view3D.mapTo3DScene(Qt.vector3d(eventPoint.position.x, eventPoint.position.y, 1))
+                var boneIndex = boneControlWindow.manipulator.pickBone(nearPoint, farPoint.minus(nearPoint))
+                if (boneIndex >= 0) {
+                    console.log("Picked bone:", boneIndex)
+                }
+            }
+        }
+
         Node {
             id: orbitCameraNode
             position: Qt.vector3d(0, 0, 0)
@@ -287,23 +364,61 @@ Window {
         }
     }
 
+    FileDialog {
+        id: motionFileDialog
+        title: "Select Motion File"
+        nameFilters: ["Motion files (*.bvh *.gltf *.glb)", "BVH files (*.bvh)", "glTF files (*.gltf *.glb)", "All files (*)"]
+        onAccepted: {
+            console.log("Importing motion:", currentFile)
+            motionImporter.startImport(currentFile.toString(), boneControlWindow.manipulator.bonesList)
+        }
+    }
+
     OrbitCameraController {
         id: orbitController
         anchors.fill: view3D
         origin: orbitCameraNode
         camera: orbitCamera
-        enabled: cameraHelper.orbitControllerEnabled
+        enabled: cameraHelper.orbitControllerEnabled && !exportWindow.exporter.viewportBusy
     }
 
     WasdController {
         id: wasdController
         anchors.fill: view3D
         controlledObject: wasdCamera
-        enabled: !cameraHelper.orbitControllerEnabled
+        enabled: !cameraHelper.orbitControllerEnabled && !exportWindow.exporter.viewportBusy
         speed: 5.0
         shiftSpeed: 15.0
     }
 
+    // Экспорт проигрывает свои кадры на этой сцене: ввод отключен, пока идет
+    // захват, затем сцена возвращается в прежнее состояние.
+    // Плашка лежит поверх View3D, а не внутри, поэтому в видео не попадает
+    Rectangle {
+        id: viewportBusyBanner
+        visible: exportWindow.exporter.viewportBusy
+        anchors {
+            top: view3D.top
+            horizontalCenter: view3D.horizontalCenter
+            topMargin: 10
+        }
+        width: busyText.implicitWidth + 30
+        height: busyText.implicitHeight + 16
+        color: "#CC333333"
+        border.color: "#FF9800"
+        radius: 5
+
+        Text {
+            id: busyText
+            anchors.centerIn: parent
+            text: "🎬 Viewport busy: exporting frame " + exportWindow.exporter.currentFrame + " / " +
+                  exportWindow.exporter.totalFrames + ". Your view is restored when capture ends."
+            color: "#FF9800"
+            font.pixelSize: 12
+            font.bold: true
+        }
+    }
+
     TimeLineView {
         id: timeline
         anchors {
@@ -313,6 +428,8 @@ Window {
         }
         height: 120
         keyframeManager: keyframeManager
+        // Во время захвата кадры выбирает экспорт
+        enabled: !exportWindow.exporter.viewportBusy
 
         onFrameSelected: function(frame) {
             console.log("Frame selected:", frame + 1)
@@ -373,11 +490,35 @@ Window {
             }
 
             Text {
-                text: "Frame: " + (timeline.currentFrame + 1) + "/30 | Keyframes: " + getKeyframeCount()
+                text: "Frame: " + (timeline.currentFrame + 1) + "/" + timeline.totalFrames + " | Keyframes: " + getKeyframeCount()
                 color: "#888888"
                 font.pixelSize: 10
             }
 
+            Text {
+                visible: keyframeManager.motionTrack !== null && !motionImporter.isImporting
+                text: "🎞️ Motion: frames " + (motionImporter.startFrame + 1) + "-" + motionImporter.endFrame +
+                      " @ " + motionImporter.sampleRate + " fps"
+                color: "#64B5F6"
+                font.pixelSize: 10
+            }
+
+            Text {
+                visible: motionImporter.isImporting
+                text: "📥 Importing motion: " + Math.round(motionImporter.progress * 100) + "%"
+                color: "#FF9800"
+                font.pixelSize: 10
+                font.bold: true
+            }
+
+            Text {
+                visible: poseStreamWindow.stream.listening
+                text: poseStreamWindow.stream.recording ? "⏺️ Recording live pose" : "📡 Live pose"
+                color: poseStreamWindow.stream.recording ? "#f44336" : "#4CAF50"
+                font.pixelSize: 10
+                font.bold: true
+            }
+
             Text {
                 text: boneControlWindow.visible ? "🦴 Bone Control: ON" : "🦴 Bone Control: OFF"
                 color: boneControlWindow.visible ? "#4CAF50" : "#888888"
@@ -386,7 +527,8 @@ Window {
             }
 
             Text {
-                text: exportWindow.exporter.isExporting ? "🎬 Exporting..." : "🎬 Export: Ready"
+                text: exportWindow.exporter.viewportBusy ? "🎬 Capturing (viewport busy)" :
+                      exportWindow.exporter.isExporting ? "🎬 Exporting..." : "🎬 Export: Ready"
                 color: exportWindow.exporter.isExporting ? "#FF9800" : "#888888"
                 font.pixelSize: 10
                 font.bold: exportWindow.exporter.isExporting
@@ -396,9 +538,20 @@ Window {
 
     Component.onCompleted: {
         console.log("Motion Plugin initialized")
+        boneControlWindow.manipulator.retargeter = retargetWindow.retargeter
         cameraHelper.resetView()
     }
 
+    // Таймлайн удлиняется до конца импортированного дубля
+    function fitTimelineToMotion() {
+        var endFrame = motionImporter.endFrame
+        if (endFrame > timeline.totalFrames) {
+            console.log("Timeline extended from", timeline.totalFrames, "to", endFrame, "frames for the imported motion")
+            timeline.totalFrames = endFrame
+        }
+        timeline.refreshDisplay()
+    }
+
     function getStatusText() {
         var status = "Ready to load model"
 
@@ -0,0 +1,957 @@
+#include "motionimporter.h"
+#include "boneutils.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QQuaternion>
+#include <QUrl>
+#include <QtEndian>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+
+// "mixamorig:LeftArm", "Bone_LeftArm" and "left_arm" all map to "leftarm"
+QString normalizedBoneName(const QString &name)
+{
+    QString n = name;
+    const int separator = std::max(n.lastIndexOf(':'), n.lastIndexOf('|'));
+    if (separator >= 0) {
+        n = n.mid(separator + 1);
+    }
+
+    n = n.toLower();
+    if (n.startsWith("bone_")) {
+        n = n.mid(5);
+    } else if (n.startsWith("node_")) {
+        n = n.mid(5);
+    }
+
+    QString result;
+    result.reserve(n.size());
+    for (const QChar c : n) {
+        if (c.isLetterOrNumber()) {
+            result.append(c);
+        }
+    }
+    return result;
+}
+
+namespace {
+
+using ProgressCallback = std::function<void(double)>;
+
+// Upper bound for frames * joints of a resampled glTF take (~1.2 GB of channels)
+constexpr qint64 MaxClipSamples = qint64(1) << 25;
+
+// A longer BVH frame time is a corrupt header, not a real take
+constexpr double MaxFrameTime = 10.0;
+
+// Reads a file line by line into one reusable buffer, so memory stays
+// constant no matter how many frames the file has
+class LineReader
+{
+public:
+    explicit LineReader(QFile &file) : m_file(file), m_buffer(4096, '\0'), m_length(0) {}
+
+    bool next()
+    {
+        m_length = 0;
+        for (;;) {
+            const qint64 read = m_file.readLine(m_buffer.data() + m_length, m_buffer.size() - m_length);
+            if (read <= 0) {
+                return m_length > 0;
+            }
+            m_length += int(read);
+            if (m_buffer[m_length - 1] == '\n' || m_file.atEnd()) {
+                return true;
+            }
+            // Line longer than the buffer, grow and keep reading
+            m_buffer.resize(m_buffer.size() * 2);
+        }
+    }
+
+    const char *begin() const { return m_buffer.constData(); }
+    const char *end() const { return m_buffer.constData() + m_length; }
+    QByteArray line() const { return QByteArray(m_buffer.constData(), m_length).trimmed(); }
+
+private:
+    QFile &m_file;
+    QByteArray m_buffer;
+    int m_length;
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Locale independent float parsing straight from the line buffer
+inline bool parseNextFloat(const char *&p, const char *end, float &value)
+{
+    while (p < end && isSpace(*p)) ++p;
+    if (p >= end) return false;
+    if (*p == '+') ++p;
+
+    const auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// BVH
+// ---------------------------------------------------------------------------
+
+enum BvhChannel {
+    XPosition, YPosition, ZPosition,
+    XRotation, YRotation, ZRotation
+};
+
+struct BvhJoint
+{
+    QString name;
+    int parent = -1;
+    QVector3D offset;
+    QVector<BvhChannel> channels;
+};
+
+bool parseBvh(QFile &file, MotionClip &clip, double positionScale,
+              const std::atomic<bool> &cancel, const ProgressCallback &progress, QString *error)
+{
+    LineReader reader(file);
+    QVector<BvhJoint> joints;
+    QVector<int> stack;          // Open joints, -1 marks an "End Site" block
+    int pendingJoint = -1;
+    bool inMotion = false;
+
+    // Hierarchy, small compared to the motion section
+    while (reader.next()) {
+        const QList<QByteArray> tokens = reader.line().simplified().split(' ');
+        if (tokens.isEmpty() || tokens.first().isEmpty()) continue;
+
+        const QByteArray &keyword = tokens.first();
+        if (keyword == "HIERARCHY") {
+            continue;
+        } else if (keyword == "ROOT" || keyword == "JOINT") {
+            BvhJoint joint;
+            joint.name = tokens.size() > 1 ? QString::fromUtf8(tokens.mid(1).join(' '))
+                                           : QString("Joint_%1").arg(joints.size());
+            joint.parent = -1;
+            for (int i = stack.size() - 1; i >= 0; --i) {
+                if (stack[i] >= 0) { joint.parent = stack[i]; break; }
+            }
+            joints.append(joint);
+            pendingJoint = joints.size() - 1;
+        } else if (keyword == "End") {
+            pendingJoint = -1;
+            stack.append(-1);
+            // The opening brace of the End Site follows on its own line
+            continue;
+        } else if (keyword == "{") {
+            if (pendingJoint >= 0) {
+                stack.append(pendingJoint);
+                pendingJoint = -1;
+            }
+        } else if (keyword == "}") {
+            if (stack.isEmpty()) {
+                *error = "Unbalanced braces in BVH hierarchy";
+                return false;
+            }
+            stack.removeLast();
+        } else if (keyword == "OFFSET") {
+            if (!stack.isEmpty() && stack.last() >= 0 && tokens.size() >= 4) {
+                joints[stack.last()].offset = QVector3D(tokens[1].toFloat(), tokens[2].toFloat(), tokens[3].toFloat());
+            }
+        } else if (keyword == "CHANNELS") {
+            if (stack.isEmpty() || stack.last() < 0) continue;
+            BvhJoint &joint = joints[stack.last()];
+            for (int i = 2; i < tokens.size(); ++i) {
+                const QByteArray channel = tokens[i].toLower();
+                if (channel == "xposition") joint.channels.append(XPosition);
+                else if (channel == "yposition") joint.channels.append(YPosition);
+                else if (channel == "zposition") joint.channels.append(ZPosition);
+                else if (channel == "xrotation") joint.channels.append(XRotation);
+                else if (channel == "yrotation") joint.channels.append(YRotation);
+                else if (channel == "zrotation") joint.channels.append(ZRotation);
+                else {
+                    *error = "Unsupported BVH channel: " + QString::fromUtf8(tokens[i]);
+                    return false;
+                }
+            }
+        } else if (keyword == "MOTION") {
+            inMotion = true;
+            break;
+        }
+    }
+
+    if (!inMotion || joints.isEmpty()) {
+        *error = "BVH file has no hierarchy or motion section";
+        return false;
+    }
+
+    // Motion header
+    int declaredFrames = -1;
+    while (reader.next()) {
+        const QByteArray line = reader.line();
+        if (line.isEmpty()) continue;
+        if (line.startsWith("Frames:")) {
+            declaredFrames = line.mid(7).trimmed().toInt();
+        } else if (line.startsWith("Frame Time:")) {
+            clip.frameTime = line.mid(11).trimmed().toDouble();
+            break;
+        }
+    }
+
+    if (declaredFrames < 0 || clip.frameTime <= 0.0) {
+        *error = "BVH motion section is missing \"Frames:\" or \"Frame Time:\"";
+        return false;
+    }
+    if (!(clip.frameTime <= MaxFrameTime)) {
+        *error = QString("BVH frame time %1 s is not plausible").arg(clip.frameTime);
+        return false;
+    }
+
+    const int jointCount = joints.size();
+    int channelCount = 0;
+    for (const BvhJoint &joint : std::as_const(joints)) {
+        clip.jointNames.append(joint.name);
+        clip.jointParents.append(joint.parent);
+        bool position = false, rotation = false;
+        for (BvhChannel channel : joint.channels) {
+            if (channel <= ZPosition) position = true;
+            else rotation = true;
+        }
+        clip.hasPosition.append(position);
+        clip.hasRotation.append(rotation);
+        clip.hasScale.append(false);
+        channelCount += joint.channels.size();
+    }
+    clip.absolute = false;
+
+    // "Frames:" is only a hint: reserve no more than the rest of the file can hold
+    // (at least two characters per value) and grow as frames are parsed
+    const qint64 remaining = std::max<qint64>(0, file.size() - file.pos());
+    const qint64 maxFrames = channelCount > 0 ? remaining / (2 * channelCount) + 1 : 1;
+    const qsizetype reservedFrames = qsizetype(std::min<qint64>(declaredFrames, maxFrames));
+    clip.positions.reserve(reservedFrames * jointCount);
+    clip.rotations.reserve(reservedFrames * jointCount);
+
+    QVector<float> values(channelCount);
+
+    // Translation channels hold absolute positions (a ROOT usually has
+    // OFFSET 0 0 0 and the hips at their full height), so positions are
+    // stored relative to the first frame: the take starts on the model's rest pose
+    QVector<QVector3D> firstPositions;
+    firstPositions.reserve(jointCount);
+
+    const qint64 fileSize = std::max<qint64>(1, file.size());
+    int lastPercent = -1;
+    int frame = 0;
+
+    while (frame < declaredFrames && reader.next()) {
+        const char *p = reader.begin();
+        const char *end = reader.end();
+
+        int parsed = 0;
+        while (parsed < channelCount && parseNextFloat(p, end, values[parsed])) {
+            ++parsed;
+        }
+        if (parsed == 0) continue; // Blank line
+        if (parsed < channelCount) {
+            *error = QString("BVH frame %1 has %2 values, expected %3").arg(frame).arg(parsed).arg(channelCount);
+            return false;
+        }
+
+        int c = 0;
+        clip.positions.resize(qsizetype(frame + 1) * jointCount);
+        clip.rotations.resize(qsizetype(frame + 1) * jointCount);
+        QVector3D *positions = clip.positions.data() + qsizetype(frame) * jointCount;
+        QVector3D *rotations = clip.rotations.data() + qsizetype(frame) * jointCount;
+        for (int j = 0; j < jointCount; ++j) {
+            const BvhJoint &joint = joints[j];
+            QVector3D position = joint.offset;
+            QQuaternion rotation;
+
+            // BVH rotations compose in the order the channels are listed
+            for (BvhChannel channel : joint.channels) {
+                const float v = values[c++];
+                switch (channel) {
+                case XPosition: position.setX(v); break;
+                case YPosition: position.setY(v); break;
+                case ZPosition: position.setZ(v); break;
+                case XRotation: rotation *= QQuaternion::fromAxisAndAngle(1, 0, 0, v); break;
+                case YRotation: rotation *= QQuaternion::fromAxisAndAngle(0, 1, 0, v); break;
+                case ZRotation: rotation *= QQuaternion::fromAxisAndAngle(0, 0, 1, v); break;
+                }
+            }
+
+            if (frame == 0) {
+                firstPositions.append(position);
+            }
+            positions[j] = (position - firstPositions[j]) * float(positionScale);
+            rotations[j] = rotation.toEulerAngles();
+        }
+
+        ++frame;
+
+        if (cancel.load(std::memory_order_relaxed)) {
+            *error = "Import was cancelled by user";
+            return false;
+        }
+
+        const int percent = int(file.pos() * 100 / fileSize);
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            progress(percent / 100.0);
+        }
+    }
+
+    // Tolerate truncated takes, keep what was read
+    if (frame < declaredFrames) {
+        qDebug() << "BVH declares" << declaredFrames << "frames but contains" << frame;
+        clip.positions.squeeze();
+        clip.rotations.squeeze();
+    }
+    clip.frameCount = frame;
+    if (frame == 0) {
+        *error = "BVH file contains no frames";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// glTF animation channels
+// ---------------------------------------------------------------------------
+
+class GltfSource
+{
+public:
+    bool open(const QString &path, QString *error)
+    {
+        m_file.setFileName(path);
+        m_baseDir = QFileInfo(path).absolutePath();
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            *error = "Cannot open " + path + ": " + m_file.errorString();
+            return false;
+        }
+
+        QByteArray json;
+        const QByteArray magic = m_file.peek(4);
+        if (magic == "glTF") {
+            // GLB: 12 byte header, then a JSON chunk and an optional BIN chunk
+            const QByteArray header = m_file.read(20);
+            if (header.size() < 20) {
+                *error = "Truncated GLB header";
+                return false;
+            }
+            const quint32 jsonLength = qFromLittleEndian<quint32>(header.constData() + 12);
+            if (qint64(jsonLength) > m_file.size() - m_file.pos()) {
+                *error = "GLB JSON chunk is longer than the file";
+                return false;
+            }
+            json = m_file.read(jsonLength);
+            const QByteArray binHeader = m_file.read(8);
+            if (binHeader.size() == 8 && qFromLittleEndian<quint32>(binHeader.constData() + 4) == 0x004E4942) {
+                m_binOffset = m_file.pos();
+            }
+        } else {
+            json = m_file.readAll();
+        }
+
+        QJsonParseError parseError;
+        m_root = QJsonDocument::fromJson(json, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            *error = "Invalid glTF JSON: " + parseError.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    const QJsonObject &root() const { return m_root; }
+
+    // Reads an accessor as floats, normalizing integer components.
+    // Only the accessor's own byte range is read from the buffer.
+    bool readAccessor(int index, int components, QVector<float> &out, QString *error)
+    {
+        const QJsonArray accessors = m_root.value("accessors").toArray();
+        if (index < 0 || index >= accessors.size()) {
+            *error = QString("glTF accessor %1 does not exist").arg(index);
+            return false;
+        }
+        const QJsonObject accessor = accessors.at(index).toObject();
+
+        const QJsonArray views = m_root.value("bufferViews").toArray();
+        const int viewIndex = accessor["bufferView"].toInt(-1);
+        if (viewIndex < 0 || viewIndex >= views.size()) {
+            *error = QString("glTF accessor %1 has no valid buffer view").arg(index);
+            return false;
+        }
+        const QJsonObject view = views.at(viewIndex).toObject();
+
+        const int count = accessor["count"].toInt(-1);
+        const int componentType = accessor["componentType"].toInt();
+        if (count < 0) {
+            *error = QString("glTF accessor %1 has an invalid count").arg(index);
+            return false;
+        }
+
+        int componentSize = 0;
+        switch (componentType) {
+        case 5126: componentSize = 4; break;            // FLOAT
+        case 5120: case 5121: componentSize = 1; break; // (UNSIGNED_)BYTE
+        case 5122: case 5123: componentSize = 2; break; // (UNSIGNED_)SHORT
+        default:
+            *error = QString("Unsupported accessor component type %1").arg(componentType);
+            return false;
+        }
+
+        const int elementSize = componentSize * components;
+        const int stride = view["byteStride"].toInt(elementSize);
+        const qint64 start = qint64(view["byteOffset"].toDouble()) + qint64(accessor["byteOffset"].toDouble());
+        const qint64 length = count > 0 ? qint64(count - 1) * stride + elementSize : 0;
+        if (stride < elementSize || start < 0) {
+            *error = QString("glTF accessor %1 has an invalid layout").arg(index);
+            return false;
+        }
+
+        QByteArray bytes;
+        if (!readBuffer(view["buffer"].toInt(), start, length, bytes, error)) {
+            return false;
+        }
+
+        out.resize(count * components);
+        for (int i = 0; i < count; ++i) {
+            const char *element = bytes.constData() + qint64(i) * stride;
+            for (int c = 0; c < components; ++c) {
+                const char *p = element + c * componentSize;
+                float v = 0.0f;
+                switch (componentType) {
+                case 5126: v = qFromLittleEndian<float>(p); break;
+                case 5120: v = std::max(float(qint8(*p)) / 127.0f, -1.0f); break;
+                case 5121: v = float(quint8(*p)) / 255.0f; break;
+                case 5122: v = std::max(float(qFromLittleEndian<qint16>(p)) / 32767.0f, -1.0f); break;
+                case 5123: v = float(qFromLittleEndian<quint16>(p)) / 65535.0f; break;
+                }
+                out[i * components + c] = v;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool readBuffer(int index, qint64 start, qint64 length, QByteArray &out, QString *error)
+    {
+        const QJsonArray buffers = m_root.value("buffers").toArray();
+        if (index < 0 || index >= buffers.size()) {
+            *error = QString("glTF buffer %1 does not exist").arg(index);
+            return false;
+        }
+        const QJsonObject buffer = buffers.at(index).toObject();
+        const QString uri = buffer["uri"].toString();
+
+        if (uri.isEmpty()) {
+            if (m_binOffset < 0) {
+                *error = "glTF buffer has no data";
+                return false;
+            }
+            return readRange(m_file, m_binOffset + start, length, out, error);
+        }
+
+        if (uri.startsWith("data:")) {
+            // Embedded buffers have to be decoded once as a whole
+            if (!m_dataUris.contains(index)) {
+                const int comma = uri.indexOf(',');
+                m_dataUris.insert(index, QByteArray::fromBase64(uri.mid(comma + 1).toLatin1()));
+            }
+            out = m_dataUris.value(index).mid(start, length);
+            if (out.size() != length) {
+                *error = "glTF accessor is out of buffer range";
+                return false;
+            }
+            return true;
+        }
+
+        QFile external(QDir(m_baseDir).filePath(QUrl::fromPercentEncoding(uri.toUtf8())));
+        if (!external.open(QIODevice::ReadOnly)) {
+            *error = "Cannot open glTF buffer " + external.fileName();
+            return false;
+        }
+        return readRange(external, start, length, out, error);
+    }
+
+    static bool readRange(QFile &file, qint64 start, qint64 length, QByteArray &out, QString *error)
+    {
+        // Checked before reading, so a bogus length never turns into an allocation
+        if (start < 0 || length < 0 || start + length > file.size() || !file.seek(start)) {
+            *error = "glTF accessor is out of buffer range";
+            return false;
+        }
+        out = file.read(length);
+        if (out.size() != length) {
+            *error = "glTF accessor is out of buffer range";
+            return false;
+        }
+        return true;
+    }
+
+    QFile m_file;
+    QString m_baseDir;
+    QJsonObject m_root;
+    qint64 m_binOffset = -1;
+    QHash<int, QByteArray> m_dataUris;
+};
+
+// Key index for time t, keys are visited with monotonically increasing t
+inline int advanceKey(const QVector<float> &times, int key, float t)
+{
+    while (key + 1 < times.size() && times[key + 1] <= t) ++key;
+    return key;
+}
+
+bool parseGltf(const QString &path, MotionClip &clip, double positionScale, int sampleRate,
+               const std::atomic<bool> &cancel, const ProgressCallback &progress, QString *error)
+{
+    GltfSource source;
+    if (!source.open(path, error)) {
+        return false;
+    }
+
+    const QJsonObject &root = source.root();
+    const QJsonArray animations = root.value("animations").toArray();
+    if (animations.isEmpty()) {
+        *error = "glTF file contains no animations";
+        return false;
+    }
+
+    const QJsonObject animation = animations.first().toObject();
+    const QJsonArray channels = animation["channels"].toArray();
+    const QJsonArray samplers = animation["samplers"].toArray();
+    const QJsonArray nodes = root.value("nodes").toArray();
+    const QJsonArray accessors = root.value("accessors").toArray();
+
+    // One joint per animated node
+    QVector<int> nodeParents(nodes.size(), -1);
+    for (int n = 0; n < nodes.size(); ++n) {
+        for (const QJsonValue &child : nodes[n].toObject().value("children").toArray()) {
+            const int childNode = child.toInt(-1);
+            if (childNode >= 0 && childNode < nodeParents.size()) nodeParents[childNode] = n;
+        }
+    }
+
+    // Indices come straight from the file, every one is checked before use
+    QHash<int, int> nodeToJoint;
+    QVector<int> jointNodes;
+    float duration = 0.0f;
+    for (int ch = 0; ch < channels.size(); ++ch) {
+        const QJsonObject channel = channels[ch].toObject();
+        const QJsonObject target = channel["target"].toObject();
+        if (!target.contains("node")) continue;
+
+        const int node = target["node"].toInt(-1);
+        if (node < 0 || node >= nodes.size()) {
+            *error = QString("glTF channel %1 targets node %2, the file has %3 nodes").arg(ch).arg(node).arg(nodes.size());
+            return false;
+        }
+
+        const int samplerIndex = channel["sampler"].toInt(-1);
+        if (samplerIndex < 0 || samplerIndex >= samplers.size()) {
+            *error = QString("glTF channel %1 uses sampler %2, the animation has %3").arg(ch).arg(samplerIndex).arg(samplers.size());
+            return false;
+        }
+
+        const QJsonObject sampler = samplers.at(samplerIndex).toObject();
+        const int input = sampler["input"].toInt(-1);
+        const int output = sampler["output"].toInt(-1);
+        if (input < 0 || input >= accessors.size() || output < 0 || output >= accessors.size()) {
+            *error = QString("glTF sampler %1 uses accessors %2/%3, the file has %4")
+                         .arg(samplerIndex).arg(input).arg(output).arg(accessors.size());
+            return false;
+        }
+
+        if (!nodeToJoint.contains(node)) {
+            nodeToJoint.insert(node, jointNodes.size());
+            jointNodes.append(node);
+        }
+
+        const QJsonArray max = accessors.at(input).toObject()["max"].toArray();
+        if (!max.isEmpty()) duration = std::max(duration, float(max.first().toDouble()));
+    }
+
+    if (jointNodes.isEmpty()) {
+        *error = "glTF animation has no node channels";
+        return false;
+    }
+
+    const int jointCount = jointNodes.size();
+    for (int node : std::as_const(jointNodes)) {
+        const QString name = nodes[node].toObject().value("name").toString();
+        clip.jointNames.append(name.isEmpty() ? QString("Node_%1").arg(node) : name);
+
+        // Bounded walk, a corrupt file may have cycles in "children"
+        int parent = nodeParents[node];
+        for (int steps = 0; parent >= 0 && !nodeToJoint.contains(parent); ++steps) {
+            parent = steps < nodes.size() ? nodeParents[parent] : -1;
+        }
+        clip.jointParents.append(parent >= 0 ? nodeToJoint.value(parent) : -1);
+    }
+    clip.hasPosition.fill(false, jointCount);
+    clip.hasRotation.fill(false, jointCount);
+    clip.hasScale.fill(false, jointCount);
+    clip.absolute = true;
+
+    const double frames = std::floor(double(duration) * sampleRate + 0.5) + 1.0;
+    if (!std::isfinite(frames) || frames * jointCount > double(MaxClipSamples)) {
+        *error = QString("glTF animation is too long to sample at %1 fps (%2 s)").arg(sampleRate).arg(duration);
+        return false;
+    }
+
+    clip.frameTime = 1.0 / sampleRate;
+    clip.frameCount = int(frames);
+    clip.positions.resize(qsizetype(clip.frameCount) * jointCount);
+    clip.rotations.resize(qsizetype(clip.frameCount) * jointCount);
+    clip.scales.fill(QVector3D(1, 1, 1), qsizetype(clip.frameCount) * jointCount);
+
+    // Channels are resampled one at a time, only one channel's keys are held in memory
+    QVector<float> times;
+    QVector<float> values;
+    for (int ch = 0; ch < channels.size(); ++ch) {
+        const QJsonObject channel = channels[ch].toObject();
+        const QJsonObject target = channel["target"].toObject();
+        const QString targetPath = target["path"].toString();
+        if (!target.contains("node") || targetPath == "weights") continue;
+
+        // Node and sampler indices were validated while collecting joints
+        const int joint = nodeToJoint.value(target["node"].toInt());
+        const bool isRotation = targetPath == "rotation";
+        const int components = isRotation ? 4 : 3;
+
+        const QJsonObject sampler = samplers.at(channel["sampler"].toInt()).toObject();
+        const QString interpolation = sampler["interpolation"].toString("LINEAR");
+        if (!source.readAccessor(sampler["input"].toInt(), 1, times, error) ||
+            !source.readAccessor(sampler["output"].toInt(), components, values, error)) {
+            return false;
+        }
+        if (times.isEmpty()) continue;
+
+        // CUBICSPLINE stores in-tangent, value, out-tangent per key; only the value is used
+        const bool cubic = interpolation == "CUBICSPLINE";
+        const int keyStride = cubic ? 3 * components : components;
+        const int valueOffset = cubic ? components : 0;
+        if (values.size() < times.size() * keyStride) {
+            *error = "glTF sampler output is shorter than its input";
+            return false;
+        }
+
+        auto keyValue = [&](int key) { return values.constData() + key * keyStride + valueOffset; };
+
+        int key = 0;
+        for (int f = 0; f < clip.frameCount; ++f) {
+            const float t = float(f * clip.frameTime);
+            key = advanceKey(times, key, t);
+            const int nextKey = std::min(key + 1, int(times.size()) - 1);
+
+            float alpha = 0.0f;
+            if (interpolation != "STEP" && nextKey != key && t > times[key]) {
+                alpha = std::min(1.0f, (t - times[key]) / (times[nextKey] - times[key]));
+            }
+
+            const float *a = keyValue(key);
+            const float *b = keyValue(nextKey);
+            const qsizetype slot = qsizetype(f) * jointCount + joint;
+
+            if (isRotation) {
+                const QQuaternion qa(a[3], a[0], a[1], a[2]);
+                const QQuaternion qb(b[3], b[0], b[1], b[2]);
+                clip.rotations[slot] = QQuaternion::slerp(qa, qb, alpha).normalized().toEulerAngles();
+            } else {
+                const QVector3D va(a[0], a[1], a[2]);
+                const QVector3D vb(b[0], b[1], b[2]);
+                const QVector3D v = va + (vb - va) * alpha;
+                if (targetPath == "translation") clip.positions[slot] = v * float(positionScale);
+                else clip.scales[slot] = v;
+            }
+        }
+
+        if (isRotation) clip.hasRotation[joint] = true;
+        else if (targetPath == "translation") clip.hasPosition[joint] = true;
+        else clip.hasScale[joint] = true;
+
+        if (cancel.load(std::memory_order_relaxed)) {
+            *error = "Import was cancelled by user";
+            return false;
+        }
+        progress(double(ch + 1) / channels.size());
+    }
+
+    return true;
+}
+
+} // namespace
+
+MotionImporter::MotionImporter(QObject *parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelRequested(false)
+    , m_progress(0.0)
+    , m_positionScale(1.0)
+    , m_sampleRate(30)
+    , m_startFrame(0)
+    , m_status("Ready")
+{
+}
+
+MotionImporter::~MotionImporter()
+{
+    if (m_thread) {
+        m_cancelRequested = true;
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+int MotionImporter::mappedJoints() const
+{
+    if (!m_clip) return 0;
+    return int(std::count_if(m_clip->boneIndices.cbegin(), m_clip->boneIndices.cend(),
+                             [](int bone) { return bone >= 0; }));
+}
+
+void MotionImporter::setPositionScale(double scale)
+{
+    if (m_positionScale != scale && scale > 0.0) {
+        m_positionScale = scale;
+        emit positionScaleChanged();
+    }
+}
+
+void MotionImporter::setSampleRate(int rate)
+{
+    if (m_sampleRate != rate && rate >= 1) {
+        m_sampleRate = rate;
+        emit sampleRateChanged();
+        emit trackChanged();
+    }
+}
+
+void MotionImporter::setStartFrame(int frame)
+{
+    if (m_startFrame != frame && frame >= 0) {
+        m_startFrame = frame;
+        emit trackChanged();
+    }
+}
+
+void MotionImporter::startImport(const QString &path, const QVariantList &bones)
+{
+    if (m_thread) {
+        qDebug() << "Import already in progress";
+        return;
+    }
+
+    QString cleanPath = path;
+    if (cleanPath.startsWith("file:")) {
+        cleanPath = QUrl(cleanPath).toLocalFile();
+    }
+
+    if (!QFileInfo::exists(cleanPath)) {
+        setStatus("Error: File not found");
+        emit importCompleted(false, "File not found: " + cleanPath);
+        return;
+    }
+
+    // Target bones by normalized name, resolved on the worker after parsing
+    QHash<QString, int> boneLookup;
+    for (const QVariant &bone : bones) {
+        const QVariantMap boneData = bone.toMap();
+        boneLookup.insert(normalizedBoneName(boneData.value("name").toString()),
+                          boneData.value("index").toInt());
+    }
+
+    const bool isBvh = cleanPath.endsWith(".bvh", Qt::CaseInsensitive);
+    const double positionScale = m_positionScale;
+    const int sampleRate = m_sampleRate;
+
+    m_cancelRequested = false;
+    setProgress(0.0);
+    setStatus("Importing " + QFileInfo(cleanPath).fileName() + "...");
+    qDebug() << "Starting motion import:" << cleanPath << "with" << boneLookup.size() << "target bones";
+
+    m_thread = QThread::create([this, cleanPath, boneLookup, isBvh, positionScale, sampleRate]() {
+        QSharedPointer<MotionClip> clip(new MotionClip);
+        QString error;
+
+        // Progress is posted to the GUI thread, at most once per percent
+        auto progress = [this](double value) {
+            QMetaObject::invokeMethod(this, [this, value]() { setProgress(value); }, Qt::QueuedConnection);
+        };
+
+        bool ok = false;
+        if (isBvh) {
+            QFile file(cleanPath);
+            if (file.open(QIODevice::ReadOnly)) {
+                ok = parseBvh(file, *clip, positionScale, m_cancelRequested, progress, &error);
+            } else {
+                error = "Cannot open " + cleanPath + ": " + file.errorString();
+            }
+        } else {
+            ok = parseGltf(cleanPath, *clip, positionScale, sampleRate, m_cancelRequested, progress, &error);
+        }
+
+        if (ok) {
+            clip->boneIndices.reserve(clip->jointCount());
+            for (const QString &joint : std::as_const(clip->jointNames)) {
+                clip->boneIndices.append(boneLookup.value(normalizedBoneName(joint), -1));
+            }
+        } else {
+            clip.reset();
+        }
+
+        QMetaObject::invokeMethod(this, [this, clip, error]() { finishImport(clip, error); }, Qt::QueuedConnection);
+    });
+
+    m_thread->start();
+    emit isImportingChanged();
+}
+
+void MotionImporter::cancelImport()
+{
+    if (m_thread) {
+        m_cancelRequested = true;
+    }
+}
+
+void MotionImporter::finishImport(QSharedPointer<MotionClip> clip, const QString &error)
+{
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        emit isImportingChanged();
+    }
+
+    if (!clip) {
+        setStatus("Error: " + error);
+        emit importCompleted(false, error);
+        return;
+    }
+
+    m_clip = clip;
+    emit clipChanged();
+    emit trackChanged();
+    setProgress(1.0);
+
+    const QString message = QString("Imported %1 frames (%2 s), %3 timeline frames at %4 fps, %5 of %6 joints mapped to bones")
+                                .arg(m_clip->frameCount)
+                                .arg(m_clip->duration(), 0, 'f', 2)
+                                .arg(timelineFrames())
+                                .arg(m_sampleRate)
+                                .arg(mappedJoints())
+                                .arg(m_clip->jointCount());
+    setStatus(message);
+    emit importCompleted(true, message);
+}
+
+int MotionImporter::timelineFrameCount(const MotionClip &clip, int rate)
+{
+    if (clip.frameCount == 0 || rate < 1) return 0;
+    return int(std::floor(clip.duration() * rate + 0.5)) + 1;
+}
+
+QVariantMap MotionImporter::sampleBoneTransforms(const MotionClip &clip, double time, const QVariantMap &restPose)
+{
+    QVariantMap transforms;
+    if (clip.frameCount == 0) {
+        return transforms;
+    }
+
+    // Clip frames on either side of time
+    const double clipFrame = std::clamp(time / clip.frameTime, 0.0, double(clip.frameCount - 1));
+    const int frame0 = int(clipFrame);
+    const int frame1 = std::min(frame0 + 1, clip.frameCount - 1);
+    const float alpha = frame1 != frame0 ? float(clipFrame - frame0) : 0.0f;
+    const bool blend = alpha > 1e-4f;
+
+    const qsizetype base0 = qsizetype(frame0) * clip.jointCount();
+    const qsizetype base1 = qsizetype(frame1) * clip.jointCount();
+    const bool hasScales = !clip.scales.isEmpty();
+
+    for (int j = 0; j < clip.jointCount(); ++j) {
+        const int bone = clip.boneIndices.value(j, -1);
+        if (bone < 0) continue;
+
+        QVector3D position;
+        QVector3D rotation;
+        QVector3D scale(1, 1, 1);
+
+        if (clip.hasPosition[j]) {
+            const QVector3D &a = clip.positions[base0 + j];
+            position = blend ? a + (clip.positions[base1 + j] - a) * alpha : a;
+        }
+        if (clip.hasRotation[j]) {
+            const QVector3D &a = clip.rotations[base0 + j];
+            rotation = blend ? QQuaternion::slerp(QQuaternion::fromEulerAngles(a),
+                                                  QQuaternion::fromEulerAngles(clip.rotations[base1 + j]),
+                                                  alpha).toEulerAngles()
+                             : a;
+        }
+        if (hasScales && clip.hasScale[j]) {
+            const QVector3D &a = clip.scales[base0 + j];
+            scale = blend ? a + (clip.scales[base1 + j] - a) * alpha : a;
+        }
+
+        // BoneManipulator stores offsets from the original pose and adds
+        // rotation offsets to the rest Euler angles
+        const QVariantMap rest = restPose.value(QString::number(bone)).toMap();
+        if (clip.absolute) {
+            if (clip.hasPosition[j]) position -= mapVector(rest.value("position"), QVector3D());
+            if (clip.hasRotation[j]) rotation -= mapVector(rest.value("rotation"), QVector3D());
+            if (clip.hasScale[j]) scale = safeDivide(scale, mapVector(rest.value("scale"), QVector3D(1, 1, 1)));
+        } else if (clip.hasRotation[j]) {
+            // Relative rotations turn the bone from its rest orientation (rest * clip),
+            // which is not the sum of Euler angles unless the rest rotation is identity
+            const QVector3D restRotation = mapVector(rest.value("rotation"), QVector3D());
+            const QQuaternion local = QQuaternion::fromEulerAngles(restRotation) * QQuaternion::fromEulerAngles(rotation);
+            rotation = local.toEulerAngles() - restRotation;
+        }
+
+        transforms.insert(QString::number(bone), QVariantMap{
+            { "position", vectorMap(position) },
+            { "rotation", vectorMap(rotation) },
+            { "scale", vectorMap(scale) }
+        });
+    }
+
+    return transforms;
+}
+
+QVariantMap MotionImporter::sampleFrame(int frame, const QVariantMap &restPose) const
+{
+    if (!m_clip || frame < m_startFrame || frame >= endFrame()) {
+        return QVariantMap();
+    }
+    return sampleBoneTransforms(*m_clip, double(frame - m_startFrame) / m_sampleRate, restPose);
+}
+
+void MotionImporter::setProgress(double progress)
+{
+    if (m_progress != progress) {
+        m_progress = progress;
+        emit progressChanged();
+        emit importProgress(m_progress, m_status);
+    }
+}
+
+void MotionImporter::setStatus(const QString &status)
+{
+    if (m_status != status) {
+        m_status = status;
+        emit statusChanged();
+        qDebug() << "Import status:" << status;
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef MOTIONIMPORTER_H
+#define MOTIONIMPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <QVector3D>
+#include <QVariant>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QDebug>
+#include <atomic>
+
+// Typed per-joint channels of an imported take, frame-major:
+// the value of joint j at frame f is stored at [f * jointCount() + j]
+struct MotionClip
+{
+    QStringList jointNames;
+    QVector<int> jointParents;      // -1 for root joints
+    QVector<int> boneIndices;       // Target bone (modelNodes index) per joint, -1 if unmapped
+    QVector<bool> hasPosition;
+    QVector<bool> hasRotation;
+    QVector<bool> hasScale;
+
+    // false: relative to the rest pose (BVH; rotations apply after the rest
+    // orientation), true: absolute local TRS (glTF)
+    bool absolute = false;
+
+    int frameCount = 0;
+    double frameTime = 1.0 / 30.0;
+
+    QVector<QVector3D> positions;   // Scene units
+    QVector<QVector3D> rotations;   // Euler angles, same convention as Node.eulerRotation
+    QVector<QVector3D> scales;
+
+    int jointCount() const { return jointNames.size(); }
+    double duration() const { return frameCount > 1 ? (frameCount - 1) * frameTime : 0.0; }
+};
+
+// Bone name without namespace, Bone_/Node_ prefix, case and separators,
+// so the same joint matches across rigs and file formats
+QString normalizedBoneName(const QString &name);
+
+class MotionImporter : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool isImporting READ isImporting NOTIFY isImportingChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(int frameCount READ frameCount NOTIFY clipChanged)
+    Q_PROPERTY(double frameTime READ frameTime NOTIFY clipChanged)
+    Q_PROPERTY(int jointCount READ jointCount NOTIFY clipChanged)
+    Q_PROPERTY(int mappedJoints READ mappedJoints NOTIFY clipChanged)
+    Q_PROPERTY(double positionScale READ positionScale WRITE setPositionScale NOTIFY positionScaleChanged)
+    Q_PROPERTY(int sampleRate READ sampleRate WRITE setSampleRate NOTIFY sampleRateChanged)
+    Q_PROPERTY(int startFrame READ startFrame WRITE setStartFrame NOTIFY trackChanged)
+    Q_PROPERTY(int endFrame READ endFrame NOTIFY trackChanged)
+    Q_PROPERTY(int timelineFrames READ timelineFrames NOTIFY trackChanged)
+    Q_PROPERTY(QString status READ status NOTIFY statusChanged)
+
+public:
+    explicit MotionImporter(QObject *parent = nullptr);
+    ~MotionImporter();
+
+    // Properties
+    bool isImporting() const { return m_thread != nullptr; }
+    double progress() const { return m_progress; }
+    int frameCount() const { return m_clip ? m_clip->frameCount : 0; }
+    double frameTime() const { return m_clip ? m_clip->frameTime : 0.0; }
+    int jointCount() const { return m_clip ? m_clip->jointCount() : 0; }
+    int mappedJoints() const;
+    double positionScale() const { return m_positionScale; }
+    int sampleRate() const { return m_sampleRate; }
+    int startFrame() const { return m_startFrame; }
+    int endFrame() const { return m_startFrame + timelineFrames(); }
+    int timelineFrames() const { return m_clip ? timelineFrameCount(*m_clip, m_sampleRate) : 0; }
+    QString status() const { return m_status; }
+
+    void setPositionScale(double scale);
+    void setSampleRate(int rate);
+    void setStartFrame(int frame);
+
+    QSharedPointer<const MotionClip> clip() const { return m_clip; }
+
+    // Timeline frames the clip covers when sampled at rate frames per second
+    static int timelineFrameCount(const MotionClip &clip, int rate);
+
+    // Bone transforms time seconds into the clip, interpolated between clip frames,
+    // in BoneManipulator.boneTransforms format keyed by bone index. restPose
+    // (BoneManipulator.originalTransforms) turns absolute glTF transforms into offsets.
+    static QVariantMap sampleBoneTransforms(const MotionClip &clip, double time,
+                                            const QVariantMap &restPose = QVariantMap());
+
+    // The take placed on the timeline: bone transforms of a timeline frame in
+    // [startFrame, endFrame), sampled at sampleRate. Empty outside the take.
+    Q_INVOKABLE QVariantMap sampleFrame(int frame, const QVariantMap &restPose = QVariantMap()) const;
+
+public slots:
+    // bones: BoneManipulator.bonesList ({ index, name, ... } entries)
+    void startImport(const QString &path, const QVariantList &bones);
+    void cancelImport();
+
+signals:
+    void isImportingChanged();
+    void progressChanged();
+    void clipChanged();
+    void positionScaleChanged();
+    void sampleRateChanged();
+    void trackChanged();
+    void statusChanged();
+    void importProgress(double progress, const QString &status);
+    void importCompleted(bool success, const QString &message);
+
+private:
+    void finishImport(QSharedPointer<MotionClip> clip, const QString &error);
+    void setProgress(double progress);
+    void setStatus(const QString &status);
+
+    QThread *m_thread;
+    std::atomic<bool> m_cancelRequested;
+
+    QSharedPointer<const MotionClip> m_clip;
+
+    double m_progress;
+    double m_positionScale;
+    int m_sampleRate;
+    int m_startFrame;
+    QString m_status;
+};
+
+#endif // MOTIONIMPORTER_H
@@ -38,6 +38,11 @@ void MotionPlugin::showUI()
 
 void MotionPlugin::registerQmlTypes() {
     qmlRegisterType<AnimationExporter>("MotionPlugin", 1, 0, "AnimationExporter");
+    qmlRegisterType<BonePicker>("MotionPlugin", 1, 0, "BonePicker");
+    qmlRegisterType<CrowdInstancing>("MotionPlugin", 1, 0, "CrowdInstancing");
+    qmlRegisterType<MotionImporter>("MotionPlugin", 1, 0, "MotionImporter");
+    qmlRegisterType<MotionRetargeter>("MotionPlugin", 1, 0, "MotionRetargeter");
+    qmlRegisterType<PoseStream>("MotionPlugin", 1, 0, "PoseStream");
 }
 
 
@@ -8,6 +8,11 @@
 #include <QtQml/QQmlContext>
 #include "pluginInterface.h"
 #include "animationexporter.h"
+#include "bonepicker.h"
+#include "crowdinstancing.h"
+#include "motionimporter.h"
+#include "motionretargeter.h"
+#include "posestream.h"
 
 class MotionPlugin : public QObject, public PluginInterface
 {
@@ -0,0 +1,523 @@
+#include "motionretargeter.h"
+#include "boneutils.h"
+#include "motionimporter.h"
+#include <QCryptographicHash>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float MinBoneLength = 1e-4f;
+
+// Below this, one worker converts everything
+constexpr int MinChunkSize = 16;
+
+inline QVector3D wrapAngles(const QVector3D &angles)
+{
+    return QVector3D(std::remainder(angles.x(), 360.0f),
+                     std::remainder(angles.y(), 360.0f),
+                     std::remainder(angles.z(), 360.0f));
+}
+
+// Name with side and rig-specific wording removed, so "Thigh_L", "thigh.l"
+// and "LeftUpLeg" all become "lupleg"
+QString aliasBoneName(const QString &name)
+{
+    QString n = name;
+    const int separator = std::max(n.lastIndexOf(':'), n.lastIndexOf('|'));
+    if (separator >= 0) {
+        n = n.mid(separator + 1);
+    }
+
+    // Split on separators and camel case: "LeftUpLeg" -> left up leg
+    QStringList tokens;
+    QString token;
+    for (const QChar c : std::as_const(n)) {
+        if (!c.isLetterOrNumber()) {
+            if (!token.isEmpty()) tokens.append(token);
+            token.clear();
+            continue;
+        }
+        if (c.isUpper() && !token.isEmpty() && token.back().isLower()) {
+            tokens.append(token);
+            token.clear();
+        }
+        token.append(c.toLower());
+    }
+    if (!token.isEmpty()) tokens.append(token);
+
+    static const QSet<QString> fillers{ "bone", "node", "jnt", "joint", "bind", "def", "mixamorig" };
+    static const QHash<QString, QString> synonyms{
+        { "pelvis", "hips" },
+        { "clavicle", "shoulder" },
+        { "upperarm", "arm" },
+        { "lowerarm", "forearm" },
+        { "thigh", "upleg" },
+        { "upperleg", "upleg" },
+        { "calf", "leg" },
+        { "shin", "leg" },
+        { "lowerleg", "leg" },
+        { "ball", "toebase" },
+        { "toe", "toebase" }
+    };
+
+    QChar side;
+    QString body;
+    for (const QString &t : std::as_const(tokens)) {
+        if (t == "l" || t == "left") {
+            side = 'l';
+        } else if (t == "r" || t == "right") {
+            side = 'r';
+        } else if (!fillers.contains(t)) {
+            body += t;
+        }
+    }
+
+    body = synonyms.value(body, body);
+    return side.isNull() ? body : QString(side) + body;
+}
+
+QVector<QVector<int>> childSlots(const RetargetSkeleton &skeleton)
+{
+    QVector<QVector<int>> children(skeleton.size());
+    for (int slot = 0; slot < skeleton.size(); ++slot) {
+        if (skeleton.parents[slot] >= 0) {
+            children[skeleton.parents[slot]].append(slot);
+        }
+    }
+    return children;
+}
+
+} // namespace
+
+MotionRetargeter::MotionRetargeter(QObject *parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelRequested(false)
+    , m_framesDone(0)
+    , m_progress(0.0)
+    , m_status("Ready")
+{
+}
+
+MotionRetargeter::~MotionRetargeter()
+{
+    if (m_thread) {
+        m_cancelRequested = true;
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+QVariantMap MotionRetargeter::skeletonProfile(const QVariantList &bones, const QVariantMap &restPose) const
+{
+    QVariantList entries;
+    entries.reserve(bones.size());
+
+    for (const QVariant &entry : bones) {
+        const QVariantMap boneData = entry.toMap();
+        const int index = boneData.value("index").toInt();
+        const QVariantMap rest = restPose.value(QString::number(index)).toMap();
+
+        entries.append(QVariantMap{
+            { "index", index },
+            { "name", boneData.value("name") },
+            { "level", boneData.value("level").toInt() },
+            { "position", vectorMap(mapVector(rest.value("position"), QVector3D())) },
+            { "rotation", vectorMap(mapVector(rest.value("rotation"), QVector3D())) },
+            { "scale", vectorMap(mapVector(rest.value("scale"), QVector3D(1, 1, 1))) }
+        });
+    }
+
+    return QVariantMap{ { "version", "1.0" }, { "bones", entries } };
+}
+
+void MotionRetargeter::setSourceSkeleton(const QVariantMap &profile)
+{
+    m_source = parseProfile(profile);
+    emit sourceChanged();
+    updateMapping();
+}
+
+void MotionRetargeter::setTargetSkeleton(const QVariantMap &profile)
+{
+    m_target = parseProfile(profile);
+    emit targetChanged();
+    updateMapping();
+}
+
+QVariantList MotionRetargeter::mapping() const
+{
+    static const char *methodNames[] = { "name", "alias", "hierarchy" };
+
+    QVariantList result;
+    if (!m_mapping) return result;
+
+    result.reserve(m_mapping->pairs.size());
+    for (const RetargetMapping::Pair &pair : m_mapping->pairs) {
+        result.append(QVariantMap{
+            { "sourceIndex", m_source->indices[pair.sourceSlot] },
+            { "targetIndex", m_target->indices[pair.targetSlot] },
+            { "sourceName", m_source->names[pair.sourceSlot] },
+            { "targetName", m_target->names[pair.targetSlot] },
+            { "method", methodNames[pair.method] },
+            { "lengthRatio", pair.lengthRatio }
+        });
+    }
+    return result;
+}
+
+QVariantMap MotionRetargeter::retargetTransforms(const QVariantMap &transforms) const
+{
+    if (!m_mapping) return QVariantMap();
+    return convert(*m_mapping, *m_target, transforms);
+}
+
+QVariantMap MotionRetargeter::retargetPose(const QVariantMap &sourceProfile, const QVariantMap &targetProfile,
+                                           const QVariantMap &transforms)
+{
+    const Skeleton source = parseProfile(sourceProfile);
+    const Skeleton target = parseProfile(targetProfile);
+    if (source->isEmpty() || target->isEmpty()) return QVariantMap();
+
+    // Same rig: indices already match, matching by name would only lose precision
+    if (source->signature == target->signature) return transforms;
+
+    const Mapping mapping = cachedMapping(source, target);
+    return convert(*mapping, *target, transforms);
+}
+
+void MotionRetargeter::clearCache()
+{
+    m_cache.clear();
+    updateMapping();
+}
+
+void MotionRetargeter::startRetarget(const QVariantList &frames)
+{
+    if (m_thread) {
+        qDebug() << "Retargeting already in progress";
+        return;
+    }
+
+    if (!m_mapping || m_mapping->pairs.isEmpty()) {
+        setStatus("Error: No bone mapping");
+        emit retargetCompleted(false, "No bones could be mapped between the source and target skeletons", QVariantList());
+        return;
+    }
+
+    QVector<int> frameNumbers;
+    QVector<QVariantMap> inputs;
+    frameNumbers.reserve(frames.size());
+    inputs.reserve(frames.size());
+    for (const QVariant &entry : frames) {
+        const QVariantMap frame = entry.toMap();
+        frameNumbers.append(frame.value("frame").toInt());
+        inputs.append(frame.value("transforms").toMap());
+    }
+
+    const Mapping mapping = m_mapping;
+    const Skeleton target = m_target;
+
+    m_cancelRequested = false;
+    m_framesDone = 0;
+    setProgress(0.0);
+    setStatus(QString("Retargeting %1 frames...").arg(inputs.size()));
+
+    m_thread = QThread::create([this, mapping, target, frameNumbers, inputs]() {
+        const int count = inputs.size();
+        QVector<QVariantMap> results(count);
+
+        // Frames are independent: a few chunks per pool thread keeps it balanced
+        const int chunkSize = std::max(MinChunkSize, count / std::max(1, m_pool.maxThreadCount() * 4));
+        for (int begin = 0; begin < count; begin += chunkSize) {
+            const int end = std::min(begin + chunkSize, count);
+            m_pool.start([this, &results, &inputs, &mapping, &target, begin, end]() {
+                for (int i = begin; i < end && !m_cancelRequested; ++i) {
+                    results[i] = convert(*mapping, *target, inputs[i]);
+                    m_framesDone.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        while (!m_pool.waitForDone(50)) {
+            const double value = count > 0 ? double(m_framesDone.load()) / count : 1.0;
+            QMetaObject::invokeMethod(this, [this, value]() { setProgress(value); }, Qt::QueuedConnection);
+        }
+
+        const bool cancelled = m_cancelRequested;
+        QVariantList output;
+        if (!cancelled) {
+            output.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                output.append(QVariantMap{ { "frame", frameNumbers[i] }, { "transforms", results[i] } });
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, output, cancelled]() { finishRetarget(output, cancelled); },
+                                  Qt::QueuedConnection);
+    });
+
+    m_thread->start();
+    emit isRetargetingChanged();
+}
+
+void MotionRetargeter::cancelRetarget()
+{
+    if (m_thread) {
+        m_cancelRequested = true;
+    }
+}
+
+MotionRetargeter::Skeleton MotionRetargeter::parseProfile(const QVariantMap &profile)
+{
+    QSharedPointer<RetargetSkeleton> skeleton(new RetargetSkeleton);
+    const QVariantList bones = profile.value("bones").toList();
+
+    // Bones are in traversal order
+    BoneParentTracker parents;
+    QByteArray signature;
+
+    for (const QVariant &entry : bones) {
+        const QVariantMap boneData = entry.toMap();
+        const int level = boneData.value("level").toInt();
+
+        const int slot = skeleton->size();
+        skeleton->indices.append(boneData.value("index").toInt());
+        skeleton->names.append(boneData.value("name").toString());
+        skeleton->parents.append(parents.push(level, slot));
+        skeleton->restPositions.append(mapVector(boneData.value("position"), QVector3D()));
+        skeleton->restRotations.append(mapVector(boneData.value("rotation"), QVector3D()));
+        skeleton->restScales.append(mapVector(boneData.value("scale"), QVector3D(1, 1, 1)));
+
+        const QVector3D p = skeleton->restPositions.last();
+        const QVector3D r = skeleton->restRotations.last();
+        signature += QString("%1|%2|%3|%4 %5 %6|%7 %8 %9;")
+                         .arg(skeleton->indices.last()).arg(skeleton->names.last()).arg(skeleton->parents.last())
+                         .arg(p.x(), 0, 'g', 5).arg(p.y(), 0, 'g', 5).arg(p.z(), 0, 'g', 5)
+                         .arg(r.x(), 0, 'g', 5).arg(r.y(), 0, 'g', 5).arg(r.z(), 0, 'g', 5)
+                         .toUtf8();
+    }
+
+    skeleton->signature = QString::fromLatin1(QCryptographicHash::hash(signature, QCryptographicHash::Sha1).toHex());
+    return skeleton;
+}
+
+MotionRetargeter::Mapping MotionRetargeter::buildMapping(const RetargetSkeleton &source, const RetargetSkeleton &target)
+{
+    QVector<int> sourceToTarget(source.size(), -1);
+    QVector<RetargetMapping::Method> methods(source.size(), RetargetMapping::Name);
+    QVector<bool> targetTaken(target.size(), false);
+
+    auto pairUp = [&](int sourceSlot, int targetSlot, RetargetMapping::Method method) {
+        sourceToTarget[sourceSlot] = targetSlot;
+        methods[sourceSlot] = method;
+        targetTaken[targetSlot] = true;
+    };
+
+    // 1. Names, exact after normalization, then with side and synonym handling
+    QString (*const namers[])(const QString &) = { normalizedBoneName, aliasBoneName };
+    const RetargetMapping::Method namerMethods[] = { RetargetMapping::Name, RetargetMapping::Alias };
+    for (int pass = 0; pass < 2; ++pass) {
+        QHash<QString, int> targetByName;
+        for (int slot = target.size() - 1; slot >= 0; --slot) {
+            if (!targetTaken[slot]) {
+                targetByName.insert(namers[pass](target.names[slot]), slot);
+            }
+        }
+
+        for (int slot = 0; slot < source.size(); ++slot) {
+            if (sourceToTarget[slot] >= 0) continue;
+            const QString key = namers[pass](source.names[slot]);
+            if (key.isEmpty()) continue;
+
+            const int targetSlot = targetByName.value(key, -1);
+            if (targetSlot >= 0 && !targetTaken[targetSlot]) {
+                pairUp(slot, targetSlot, namerMethods[pass]);
+            }
+        }
+    }
+
+    // 2. Hierarchy: unmatched children of mapped bones pair up in order when
+    // both sides have the same number of them. Roots are treated the same way.
+    const QVector<QVector<int>> sourceChildren = childSlots(source);
+    const QVector<QVector<int>> targetChildren = childSlots(target);
+
+    auto pairChildren = [&](const QVector<int> &sourceSlots, const QVector<int> &targetSlots) {
+        QVector<int> openSource;
+        QVector<int> openTarget;
+        for (int slot : sourceSlots) {
+            if (sourceToTarget[slot] < 0) openSource.append(slot);
+        }
+        for (int slot : targetSlots) {
+            if (!targetTaken[slot]) openTarget.append(slot);
+        }
+        if (openSource.isEmpty() || openSource.size() != openTarget.size()) return false;
+
+        for (int i = 0; i < openSource.size(); ++i) {
+            pairUp(openSource[i], openTarget[i], RetargetMapping::Hierarchy);
+        }
+        return true;
+    };
+
+    QVector<int> sourceRoots;
+    QVector<int> targetRoots;
+    for (int slot = 0; slot < source.size(); ++slot) {
+        if (source.parents[slot] < 0) sourceRoots.append(slot);
+    }
+    for (int slot = 0; slot < target.size(); ++slot) {
+        if (target.parents[slot] < 0) targetRoots.append(slot);
+    }
+    pairChildren(sourceRoots, targetRoots);
+
+    // Parents come before children, so one pass reaches the leaves
+    for (int slot = 0; slot < source.size(); ++slot) {
+        if (sourceToTarget[slot] >= 0) {
+            pairChildren(sourceChildren[slot], targetChildren[sourceToTarget[slot]]);
+        }
+    }
+
+    // 3. Compensation per pair
+    QSharedPointer<RetargetMapping> mapping(new RetargetMapping);
+    QVector<float> ratios;
+
+    for (int slot = 0; slot < source.size(); ++slot) {
+        const int targetSlot = sourceToTarget[slot];
+        if (targetSlot < 0) continue;
+
+        RetargetMapping::Pair pair;
+        pair.sourceSlot = slot;
+        pair.targetSlot = targetSlot;
+        pair.method = methods[slot];
+        pair.sourceRestEuler = source.restRotations[slot];
+        pair.targetRestEuler = target.restRotations[targetSlot];
+        pair.sourceRestInverse = QQuaternion::fromEulerAngles(pair.sourceRestEuler).inverted();
+        pair.targetRest = QQuaternion::fromEulerAngles(pair.targetRestEuler);
+
+        // Bone length is the offset from the parent; roots get the overall scale below
+        const float sourceLength = source.restPositions[slot].length();
+        const float targetLength = target.restPositions[targetSlot].length();
+        const bool hasLength = source.parents[slot] >= 0 && sourceLength > MinBoneLength && targetLength > MinBoneLength;
+        pair.lengthRatio = hasLength ? targetLength / sourceLength : 0.0f;
+        if (hasLength) {
+            ratios.append(pair.lengthRatio);
+        }
+
+        mapping->bySourceIndex.insert(source.indices[slot], mapping->pairs.size());
+        mapping->pairs.append(pair);
+    }
+
+    // Median, so a few oddly proportioned bones don't skew the root motion
+    if (!ratios.isEmpty()) {
+        std::nth_element(ratios.begin(), ratios.begin() + ratios.size() / 2, ratios.end());
+        mapping->globalScale = ratios[ratios.size() / 2];
+    }
+    for (RetargetMapping::Pair &pair : mapping->pairs) {
+        if (pair.lengthRatio <= 0.0f) {
+            pair.lengthRatio = mapping->globalScale;
+        }
+    }
+
+    qDebug() << "MotionRetargeter: mapped" << mapping->pairs.size() << "of" << source.size()
+             << "source bones to" << target.size() << "target bones, scale" << mapping->globalScale;
+    return mapping;
+}
+
+QVariantMap MotionRetargeter::convert(const RetargetMapping &mapping, const RetargetSkeleton &target,
+                                      const QVariantMap &transforms)
+{
+    QVariantMap result;
+
+    for (auto it = transforms.cbegin(); it != transforms.cend(); ++it) {
+        const auto pairIt = mapping.bySourceIndex.constFind(it.key().toInt());
+        if (pairIt == mapping.bySourceIndex.cend()) continue;
+
+        const RetargetMapping::Pair &pair = mapping.pairs[*pairIt];
+        const QVariantMap transform = it.value().toMap();
+
+        const QVector3D position = mapVector(transform.value("position"), QVector3D());
+        const QVector3D rotation = mapVector(transform.value("rotation"), QVector3D());
+        const QVector3D scale = mapVector(transform.value("scale"), QVector3D(1, 1, 1));
+
+        // Same parent-space rotation delta, applied on the target's rest pose
+        QVector3D targetRotation;
+        if (!rotation.isNull()) {
+            const QQuaternion sourceLocal = QQuaternion::fromEulerAngles(pair.sourceRestEuler + rotation);
+            const QQuaternion targetLocal = sourceLocal * pair.sourceRestInverse * pair.targetRest;
+            targetRotation = wrapAngles(targetLocal.toEulerAngles() - pair.targetRestEuler);
+        }
+
+        result.insert(QString::number(target.indices[pair.targetSlot]), QVariantMap{
+            { "position", vectorMap(position * pair.lengthRatio) },
+            { "rotation", vectorMap(targetRotation) },
+            { "scale", vectorMap(scale) }
+        });
+    }
+
+    return result;
+}
+
+MotionRetargeter::Mapping MotionRetargeter::cachedMapping(const Skeleton &source, const Skeleton &target)
+{
+    const QString key = source->signature + '/' + target->signature;
+    auto it = m_cache.constFind(key);
+    if (it != m_cache.cend()) {
+        return *it;
+    }
+
+    const Mapping mapping = buildMapping(*source, *target);
+    m_cache.insert(key, mapping);
+    return mapping;
+}
+
+void MotionRetargeter::updateMapping()
+{
+    if (m_source && m_target && !m_source->isEmpty() && !m_target->isEmpty()) {
+        m_mapping = cachedMapping(m_source, m_target);
+        setStatus(QString("%1 of %2 bones mapped").arg(m_mapping->pairs.size()).arg(m_source->size()));
+    } else {
+        m_mapping.reset();
+    }
+    emit mappingChanged();
+}
+
+void MotionRetargeter::finishRetarget(const QVariantList &frames, bool cancelled)
+{
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        emit isRetargetingChanged();
+    }
+
+    if (cancelled) {
+        setStatus("Retargeting cancelled");
+        emit retargetCompleted(false, "Retargeting was cancelled by user", QVariantList());
+        return;
+    }
+
+    setProgress(1.0);
+    const QString message = QString("Retargeted %1 frames, %2 bones mapped")
+                                .arg(frames.size())
+                                .arg(mappedBones());
+    setStatus(message);
+    emit retargetCompleted(true, message, frames);
+}
+
+void MotionRetargeter::setProgress(double progress)
+{
+    if (m_progress != progress) {
+        m_progress = progress;
+        emit progressChanged();
+    }
+}
+
+void MotionRetargeter::setStatus(const QString &status)
+{
+    if (m_status != status) {
+        m_status = status;
+        emit statusChanged();
+        qDebug() << "Retarget status:" << status;
+    }
+}
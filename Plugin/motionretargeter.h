@@ -0,0 +1,153 @@
+#ifndef MOTIONRETARGETER_H
+#define MOTIONRETARGETER_H
+
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+#include <QQuaternion>
+#include <QVariant>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QDebug>
+#include <atomic>
+
+// Bones of one character in bonesList order, with their rest pose
+struct RetargetSkeleton
+{
+    QVector<int> indices;           // modelNodes index per bone
+    QStringList names;
+    QVector<int> parents;           // Bone slot of the parent, -1 for roots
+    QVector<QVector3D> restPositions;
+    QVector<QVector3D> restRotations; // Euler angles, as in BoneManipulator.originalTransforms
+    QVector<QVector3D> restScales;
+    QString signature;              // Identifies the rig for the mapping cache
+
+    int size() const { return indices.size(); }
+    bool isEmpty() const { return indices.isEmpty(); }
+};
+
+// Source -> target bone pairs with their precomputed compensation
+struct RetargetMapping
+{
+    enum Method {
+        Name,       // Same normalized name
+        Alias,      // Same name after side and synonym handling ("Thigh_L" / "LeftUpLeg")
+        Hierarchy   // Same place under an already mapped parent
+    };
+
+    struct Pair
+    {
+        int sourceSlot;
+        int targetSlot;
+        Method method;
+        float lengthRatio;          // Target / source bone length
+        QVector3D sourceRestEuler;
+        QVector3D targetRestEuler;
+        QQuaternion sourceRestInverse;
+        QQuaternion targetRest;
+    };
+
+    QVector<Pair> pairs;
+    QHash<int, int> bySourceIndex;  // Source modelNodes index -> pair
+    float globalScale = 1.0f;
+};
+
+// Converts keyframe bone transforms authored on one skeleton to another.
+// Bones are paired by name, then by hierarchy; the mapping for a pair of
+// rigs is built once and cached by the rigs' signatures. Rotations are
+// carried over as parent-space deltas from the source rest pose onto the
+// target rest pose, translations are scaled by the bone length ratio.
+// Whole animations are converted on a thread pool, frames in parallel.
+class MotionRetargeter : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int sourceBones READ sourceBones NOTIFY sourceChanged)
+    Q_PROPERTY(int targetBones READ targetBones NOTIFY targetChanged)
+    Q_PROPERTY(int mappedBones READ mappedBones NOTIFY mappingChanged)
+    Q_PROPERTY(double scale READ scale NOTIFY mappingChanged)
+    Q_PROPERTY(int cachedMappings READ cachedMappings NOTIFY mappingChanged)
+    Q_PROPERTY(bool isRetargeting READ isRetargeting NOTIFY isRetargetingChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(QString status READ status NOTIFY statusChanged)
+
+public:
+    explicit MotionRetargeter(QObject *parent = nullptr);
+    ~MotionRetargeter();
+
+    // Properties
+    int sourceBones() const { return m_source ? m_source->size() : 0; }
+    int targetBones() const { return m_target ? m_target->size() : 0; }
+    int mappedBones() const { return m_mapping ? m_mapping->pairs.size() : 0; }
+    double scale() const { return m_mapping ? m_mapping->globalScale : 1.0; }
+    int cachedMappings() const { return m_cache.size(); }
+    bool isRetargeting() const { return m_thread != nullptr; }
+    double progress() const { return m_progress; }
+    QString status() const { return m_status; }
+
+    // JSON-friendly description of a skeleton, stored with keyframes and poses.
+    // bones: BoneManipulator.bonesList, restPose: BoneManipulator.originalTransforms
+    Q_INVOKABLE QVariantMap skeletonProfile(const QVariantList &bones, const QVariantMap &restPose) const;
+
+    Q_INVOKABLE void setSourceSkeleton(const QVariantMap &profile);
+    Q_INVOKABLE void setTargetSkeleton(const QVariantMap &profile);
+
+    // Current pairs as { sourceIndex, targetIndex, sourceName, targetName, method, lengthRatio }
+    Q_INVOKABLE QVariantList mapping() const;
+
+    // One pose (BoneManipulator.boneTransforms format) from source to target
+    Q_INVOKABLE QVariantMap retargetTransforms(const QVariantMap &transforms) const;
+
+    // Stateless variant for poses that carry their own skeleton. Returns the
+    // transforms unchanged for the same rig, an empty map if nothing maps
+    Q_INVOKABLE QVariantMap retargetPose(const QVariantMap &sourceProfile, const QVariantMap &targetProfile,
+                                         const QVariantMap &transforms);
+
+    Q_INVOKABLE void clearCache();
+
+public slots:
+    // frames: [{ frame, transforms }], result through retargetCompleted()
+    void startRetarget(const QVariantList &frames);
+    void cancelRetarget();
+
+signals:
+    void sourceChanged();
+    void targetChanged();
+    void mappingChanged();
+    void isRetargetingChanged();
+    void progressChanged();
+    void statusChanged();
+    void retargetCompleted(bool success, const QString &message, const QVariantList &frames);
+
+private:
+    using Skeleton = QSharedPointer<const RetargetSkeleton>;
+    using Mapping = QSharedPointer<const RetargetMapping>;
+
+    static Skeleton parseProfile(const QVariantMap &profile);
+    static Mapping buildMapping(const RetargetSkeleton &source, const RetargetSkeleton &target);
+    static QVariantMap convert(const RetargetMapping &mapping, const RetargetSkeleton &target,
+                               const QVariantMap &transforms);
+
+    Mapping cachedMapping(const Skeleton &source, const Skeleton &target);
+    void updateMapping();
+    void finishRetarget(const QVariantList &frames, bool cancelled);
+    void setProgress(double progress);
+    void setStatus(const QString &status);
+
+    Skeleton m_source;
+    Skeleton m_target;
+    Mapping m_mapping;
+    QHash<QString, Mapping> m_cache;    // "source signature/target signature" -> mapping
+
+    QThread *m_thread;
+    QThreadPool m_pool;
+    std::atomic<bool> m_cancelRequested;
+    std::atomic<int> m_framesDone;
+
+    double m_progress;
+    QString m_status;
+};
+
+#endif // MOTIONRETARGETER_H
@@ -0,0 +1,596 @@
+#include "posestream.h"
+#include "boneutils.h"
+#include <QUdpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <QtMath>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+constexpr quint32 PacketMagic = 0x4553504d; // "MPSE"
+constexpr quint16 PacketVersion = 1;
+constexpr qsizetype HeaderSize = 12;
+constexpr qsizetype BoneSize = 44;
+constexpr int MaxBones = 1024;
+
+// Worker threads have no event loop, they wake up at least this often to check for stop()
+constexpr int PollInterval = 50;
+
+// Sequence numbers further back than this mean the sender was restarted
+constexpr qint32 SequenceRestart = 1000;
+
+// Reordering never holds back this many packets in a row; a sender restarted
+// with a fixed port and a small sequence number is picked up after them
+constexpr int StaleRestart = 8;
+
+inline float readFloat(const char *data)
+{
+    return qFromLittleEndian<float>(data);
+}
+
+inline void writeFloat(char *data, float value)
+{
+    qToLittleEndian<float>(value, data);
+}
+
+// Size of the packet at data, 0 if more bytes are needed, -1 if it isn't a pose packet
+qsizetype packetSize(const char *data, qsizetype size)
+{
+    if (size < HeaderSize) return 0;
+    if (qFromLittleEndian<quint32>(data) != PacketMagic ||
+        qFromLittleEndian<quint16>(data + 4) != PacketVersion) {
+        return -1;
+    }
+
+    const int boneCount = qFromLittleEndian<quint16>(data + 6);
+    if (boneCount > MaxBones) return -1;
+
+    const qsizetype total = HeaderSize + boneCount * BoneSize;
+    return size >= total ? total : 0;
+}
+
+void parseBones(const char *data, PosePacket &packet)
+{
+    const int boneCount = qFromLittleEndian<quint16>(data + 6);
+    packet.sequence = qFromLittleEndian<quint32>(data + 8);
+    packet.bones.resize(boneCount);
+
+    const char *bone = data + HeaderSize;
+    for (PoseSample &sample : packet.bones) {
+        sample.bone = qFromLittleEndian<quint16>(bone);
+        sample.flags = quint8(bone[2]);
+        sample.position = QVector3D(readFloat(bone + 4), readFloat(bone + 8), readFloat(bone + 12));
+        sample.rotation = QQuaternion(readFloat(bone + 28), readFloat(bone + 16),
+                                      readFloat(bone + 20), readFloat(bone + 24));
+        sample.scale = QVector3D(readFloat(bone + 32), readFloat(bone + 36), readFloat(bone + 40));
+        bone += BoneSize;
+    }
+}
+
+QByteArray buildPacket(quint32 sequence, const QVector<PoseSample> &bones)
+{
+    QByteArray packet(HeaderSize + bones.size() * BoneSize, '\0');
+    char *data = packet.data();
+
+    qToLittleEndian<quint32>(PacketMagic, data);
+    qToLittleEndian<quint16>(PacketVersion, data + 4);
+    qToLittleEndian<quint16>(quint16(bones.size()), data + 6);
+    qToLittleEndian<quint32>(sequence, data + 8);
+
+    char *bone = data + HeaderSize;
+    for (const PoseSample &sample : bones) {
+        qToLittleEndian<quint16>(quint16(sample.bone), bone);
+        bone[2] = char(sample.flags);
+        writeFloat(bone + 4, sample.position.x());
+        writeFloat(bone + 8, sample.position.y());
+        writeFloat(bone + 12, sample.position.z());
+        writeFloat(bone + 16, sample.rotation.x());
+        writeFloat(bone + 20, sample.rotation.y());
+        writeFloat(bone + 24, sample.rotation.z());
+        writeFloat(bone + 28, sample.rotation.scalar());
+        writeFloat(bone + 32, sample.scale.x());
+        writeFloat(bone + 36, sample.scale.y());
+        writeFloat(bone + 40, sample.scale.z());
+        bone += BoneSize;
+    }
+
+    return packet;
+}
+
+} // namespace
+
+PoseStream::PoseStream(QObject *parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_stopRequested(false)
+    , m_simulatorThread(nullptr)
+    , m_stopSimulator(false)
+    , m_packetsReceived(0)
+    , m_packetsDropped(0)
+    , m_hasPose(false)
+    , m_latency(0.0)
+    , m_transport("udp")
+    , m_port(49160)
+    , m_serverName("MotionPluginPose")
+    , m_status("Ready")
+    , m_recording(false)
+    , m_recordRate(24.0)
+    , m_recordStart(0)
+    , m_nextRecordSample(0)
+{
+    m_clock.start();
+}
+
+PoseStream::~PoseStream()
+{
+    m_stopSimulator = true;
+    m_stopRequested = true;
+
+    if (m_simulatorThread) {
+        m_simulatorThread->wait();
+        delete m_simulatorThread;
+    }
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void PoseStream::setTransport(const QString &transport)
+{
+    if (m_transport != transport && (transport == "udp" || transport == "local")) {
+        m_transport = transport;
+        emit transportChanged();
+    }
+}
+
+void PoseStream::setPort(int port)
+{
+    if (m_port != port && port > 0 && port <= 65535) {
+        m_port = port;
+        emit portChanged();
+    }
+}
+
+void PoseStream::setServerName(const QString &name)
+{
+    if (m_serverName != name && !name.isEmpty()) {
+        m_serverName = name;
+        emit serverNameChanged();
+    }
+}
+
+void PoseStream::setRecording(bool recording)
+{
+    if (m_recording != recording) {
+        m_recording = recording;
+        m_recordStart = m_clock.nsecsElapsed();
+        m_nextRecordSample = 0;
+        emit recordingChanged();
+        setStatus(m_recording ? QString("Recording at %1 Hz").arg(m_recordRate)
+                              : (listening() ? "Listening" : "Ready"));
+    }
+}
+
+void PoseStream::setRecordRate(double rate)
+{
+    if (m_recordRate != rate && rate > 0.0) {
+        m_recordRate = rate;
+        // Keep the sample clock continuous if the rate changes mid-take
+        m_recordStart = m_clock.nsecsElapsed() - qint64(m_nextRecordSample * 1e9 / m_recordRate);
+        emit recordRateChanged();
+    }
+}
+
+void PoseStream::setBones(const QVariantList &nodes, const QVariantMap &restPose)
+{
+    m_targets.clear();
+    m_targets.resize(nodes.size());
+    m_offsets.clear();
+
+    int bound = 0;
+    for (int i = 0; i < nodes.size(); ++i) {
+        QObject *node = nodes.at(i).value<QObject *>();
+        if (!node) continue;
+
+        const QMetaObject *meta = node->metaObject();
+        const int position = meta->indexOfProperty("position");
+        const int rotation = meta->indexOfProperty("eulerRotation");
+        const int scale = meta->indexOfProperty("scale");
+        if (position < 0 || rotation < 0 || scale < 0) continue;
+
+        Target &target = m_targets[i];
+        target.node = node;
+        target.position = meta->property(position);
+        target.rotation = meta->property(rotation);
+        target.scale = meta->property(scale);
+
+        // Offsets are relative to the same rest pose BoneManipulator uses
+        const QVariantMap rest = restPose.value(QString::number(i)).toMap();
+        target.restPosition = mapVector(rest.value("position"), target.position.read(node).value<QVector3D>());
+        target.restRotation = mapVector(rest.value("rotation"), target.rotation.read(node).value<QVector3D>());
+        target.restScale = mapVector(rest.value("scale"), target.scale.read(node).value<QVector3D>());
+        ++bound;
+    }
+
+    qDebug() << "PoseStream: bound" << bound << "of" << nodes.size() << "nodes";
+}
+
+void PoseStream::start()
+{
+    if (m_thread) {
+        qDebug() << "Pose stream already listening";
+        return;
+    }
+
+    m_stopRequested = false;
+    m_packetsReceived = 0;
+    m_packetsDropped = 0;
+    m_hasPose = false;
+    emit statsChanged();
+
+    const bool udp = m_transport == "udp";
+    const int port = m_port;
+    const QString serverName = m_serverName;
+
+    m_thread = QThread::create([this, udp, port, serverName]() {
+        if (udp) {
+            receiveUdp(port);
+        } else {
+            receiveLocal(serverName);
+        }
+    });
+
+    // Packets should reach the ring as soon as they arrive
+    m_thread->start(QThread::TimeCriticalPriority);
+
+    setStatus(udp ? QString("Listening on UDP port %1").arg(port)
+                  : QString("Listening on local socket \"%1\"").arg(serverName));
+    emit listeningChanged();
+}
+
+void PoseStream::stop()
+{
+    if (m_thread) {
+        // The worker notices within one poll interval and reports back
+        m_stopRequested = true;
+        setRecording(false);
+        setStatus("Stopping...");
+    }
+}
+
+void PoseStream::receiveUdp(int port)
+{
+    QUdpSocket socket;
+    if (!socket.bind(QHostAddress::Any, quint16(port))) {
+        const QString error = "Cannot bind UDP port " + QString::number(port) + ": " + socket.errorString();
+        QMetaObject::invokeMethod(this, [this, error]() { finishListening(error); }, Qt::QueuedConnection);
+        return;
+    }
+
+    QByteArray datagram;
+    SequenceState sequence;
+    QHostAddress senderAddress;
+    quint16 senderPort = 0;
+
+    while (!m_stopRequested) {
+        if (!socket.hasPendingDatagrams() && !socket.waitForReadyRead(PollInterval)) {
+            continue;
+        }
+
+        while (socket.hasPendingDatagrams()) {
+            const qint64 size = socket.pendingDatagramSize();
+            datagram.resize(std::max<qint64>(size, 0));
+            QHostAddress address;
+            quint16 fromPort = 0;
+            const qint64 read = socket.readDatagram(datagram.data(), datagram.size(), &address, &fromPort);
+
+            // A new sender (or the same one restarted on a new port) starts its own sequence
+            if (read > 0 && (fromPort != senderPort || address != senderAddress)) {
+                senderAddress = address;
+                senderPort = fromPort;
+                sequence = SequenceState();
+            }
+
+            if (read <= 0 || pushPacket(datagram.constData(), read, sequence) <= 0) {
+                m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    QMetaObject::invokeMethod(this, [this]() { finishListening(QString()); }, Qt::QueuedConnection);
+}
+
+void PoseStream::receiveLocal(const QString &serverName)
+{
+    QLocalServer server;
+    QLocalServer::removeServer(serverName);
+    if (!server.listen(serverName)) {
+        const QString error = "Cannot listen on local socket \"" + serverName + "\": " + server.errorString();
+        QMetaObject::invokeMethod(this, [this, error]() { finishListening(error); }, Qt::QueuedConnection);
+        return;
+    }
+
+    QByteArray buffer;
+    while (!m_stopRequested) {
+        if (!server.hasPendingConnections() && !server.waitForNewConnection(PollInterval)) {
+            continue;
+        }
+
+        // One sender at a time, the ring has a single producer anyway
+        QLocalSocket *client = server.nextPendingConnection();
+        if (!client) continue;
+
+        buffer.clear();
+        SequenceState sequence;
+
+        while (!m_stopRequested && client->state() == QLocalSocket::ConnectedState) {
+            if (!client->bytesAvailable() && !client->waitForReadyRead(PollInterval)) {
+                continue;
+            }
+
+            buffer.append(client->readAll());
+
+            // Stream transport: split into packets by the header's bone count
+            qsizetype offset = 0;
+            while (offset < buffer.size()) {
+                const qsizetype consumed = pushPacket(buffer.constData() + offset, buffer.size() - offset, sequence);
+                if (consumed == 0) break;
+                if (consumed < 0) {
+                    // Lost framing, skip to the next magic
+                    const int next = buffer.indexOf("MPSE", offset + 1);
+                    offset = next >= 0 ? next : buffer.size();
+                    m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                offset += consumed;
+            }
+            buffer.remove(0, offset);
+        }
+
+        delete client;
+    }
+
+    QMetaObject::invokeMethod(this, [this]() { finishListening(QString()); }, Qt::QueuedConnection);
+}
+
+qsizetype PoseStream::pushPacket(const char *data, qsizetype size, SequenceState &sequence)
+{
+    const qsizetype total = packetSize(data, size);
+    if (total <= 0) return total;
+
+    // Datagrams may arrive out of order, an older pose must not replace a newer one
+    const quint32 number = qFromLittleEndian<quint32>(data + 8);
+    const qint32 age = qint32(number - sequence.last);
+    if (sequence.valid && age <= 0 && age > -SequenceRestart && ++sequence.stale < StaleRestart) {
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return total;
+    }
+    sequence.last = number;
+    sequence.valid = true;
+    sequence.stale = 0;
+
+    // Parse straight into the ring slot. A full ring means the GUI thread is
+    // stalled; the packet is dropped rather than waiting for it.
+    PosePacket *slot = m_ring.beginWrite();
+    if (!slot) {
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return total;
+    }
+
+    parseBones(data, *slot);
+    slot->receivedAt = m_clock.nsecsElapsed();
+    m_ring.endWrite();
+
+    m_packetsReceived.fetch_add(1, std::memory_order_relaxed);
+    return total;
+}
+
+bool PoseStream::applyLatest()
+{
+    // Only the newest pose matters, older ones are skipped. Swapping keeps
+    // the bone buffers allocated on both sides.
+    bool received = false;
+    while (PosePacket *packet = m_ring.front()) {
+        std::swap(m_current.bones, packet->bones);
+        m_current.sequence = packet->sequence;
+        m_current.receivedAt = packet->receivedAt;
+        m_ring.pop();
+        received = true;
+    }
+
+    if (received) {
+        m_hasPose = true;
+
+        for (const PoseSample &sample : std::as_const(m_current.bones)) {
+            if (sample.bone < 0 || sample.bone >= m_targets.size()) continue;
+
+            const Target &target = m_targets[sample.bone];
+            QObject *node = target.node;
+            if (!node) continue;
+
+            const bool absolute = sample.flags & PoseSample::Absolute;
+            Offset &offset = m_offsets[sample.bone];
+
+            if (sample.flags & PoseSample::HasPosition) {
+                offset.position = absolute ? sample.position - target.restPosition : sample.position;
+                target.position.write(node, QVariant::fromValue(target.restPosition + offset.position));
+            }
+
+            if (sample.flags & PoseSample::HasRotation) {
+                const QVector3D euler = sample.rotation.normalized().toEulerAngles();
+                offset.rotation = absolute ? euler - target.restRotation : euler;
+                target.rotation.write(node, QVariant::fromValue(target.restRotation + offset.rotation));
+            }
+
+            if (sample.flags & PoseSample::HasScale) {
+                offset.scale = absolute ? safeDivide(sample.scale, target.restScale) : sample.scale;
+                target.scale.write(node, QVariant::fromValue(target.restScale * offset.scale));
+            }
+        }
+
+        const double latency = (m_clock.nsecsElapsed() - m_current.receivedAt) / 1e6;
+        m_latency = m_latency > 0.0 ? 0.9 * m_latency + 0.1 * latency : latency;
+        emit poseApplied();
+    }
+
+    // Fixed-rate samples; a late frame repeats the pose for the samples it missed
+    if (m_recording && m_hasPose) {
+        const double elapsed = (m_clock.nsecsElapsed() - m_recordStart) / 1e9;
+        const int due = int(elapsed * m_recordRate);
+        if (due >= m_nextRecordSample) {
+            const QVariantMap transforms = currentTransforms();
+            while (m_recording && m_nextRecordSample <= due) {
+                emit poseRecorded(m_nextRecordSample++, transforms);
+            }
+        }
+    }
+
+    emit statsChanged();
+    return received;
+}
+
+QVariantMap PoseStream::currentTransforms() const
+{
+    QVariantMap transforms;
+    for (auto it = m_offsets.cbegin(); it != m_offsets.cend(); ++it) {
+        transforms.insert(QString::number(it.key()), QVariantMap{
+            { "position", vectorMap(it.value().position) },
+            { "rotation", vectorMap(it.value().rotation) },
+            { "scale", vectorMap(it.value().scale) }
+        });
+    }
+    return transforms;
+}
+
+void PoseStream::startSimulator(double rate)
+{
+    if (m_simulatorThread || rate <= 0.0) return;
+
+    QVector<int> bones;
+    for (int i = 0; i < m_targets.size(); ++i) {
+        if (m_targets[i].node) bones.append(i);
+    }
+
+    if (bones.isEmpty()) {
+        setStatus("Simulator: no bones to animate");
+        return;
+    }
+
+    m_stopSimulator = false;
+    const bool udp = m_transport == "udp";
+    const int port = m_port;
+    const QString serverName = m_serverName;
+
+    m_simulatorThread = QThread::create([this, bones, rate, udp, port, serverName]() {
+        runSimulator(bones, rate, udp, port, serverName);
+    });
+    m_simulatorThread->start();
+    emit simulatingChanged();
+}
+
+void PoseStream::stopSimulator()
+{
+    if (m_simulatorThread) {
+        m_stopSimulator = true;
+    }
+}
+
+void PoseStream::runSimulator(const QVector<int> &bones, double rate, bool udp, int port, const QString &serverName)
+{
+    QUdpSocket udpSocket;
+    QLocalSocket localSocket;
+    if (!udp) {
+        localSocket.connectToServer(serverName);
+        if (!localSocket.waitForConnected(1000)) {
+            const QString error = "Cannot connect to \"" + serverName + "\": " + localSocket.errorString();
+            QMetaObject::invokeMethod(this, [this, error]() { finishSimulator(error); }, Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    // Every bone sways around its rest pose, each one a bit out of phase
+    QVector<PoseSample> samples(bones.size());
+    for (int i = 0; i < bones.size(); ++i) {
+        samples[i].bone = bones[i];
+        samples[i].flags = PoseSample::HasRotation;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    const auto begin = Clock::now();
+    auto next = begin;
+    quint32 sequence = 0;
+
+    while (!m_stopSimulator) {
+        const float t = std::chrono::duration<float>(Clock::now() - begin).count();
+        for (int i = 0; i < samples.size(); ++i) {
+            const float phase = 2.0f * float(M_PI) * 0.5f * t + 0.3f * i;
+            samples[i].rotation = QQuaternion::fromEulerAngles(10.0f * std::sin(phase), 0.0f,
+                                                               15.0f * std::sin(phase * 0.7f));
+        }
+
+        const QByteArray packet = buildPacket(sequence++, samples);
+        if (udp) {
+            udpSocket.writeDatagram(packet, QHostAddress::LocalHost, quint16(port));
+        } else {
+            if (localSocket.state() != QLocalSocket::ConnectedState) break;
+            localSocket.write(packet);
+            localSocket.waitForBytesWritten(PollInterval);
+        }
+
+        next += interval;
+        std::this_thread::sleep_until(next);
+    }
+
+    QMetaObject::invokeMethod(this, [this]() { finishSimulator(QString()); }, Qt::QueuedConnection);
+}
+
+void PoseStream::finishListening(const QString &error)
+{
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        emit listeningChanged();
+    }
+
+    if (!error.isEmpty()) {
+        setStatus("Error: " + error);
+        emit streamError(error);
+        return;
+    }
+
+    setStatus(QString("Stopped after %1 packets (%2 dropped)")
+                  .arg(packetsReceived())
+                  .arg(packetsDropped()));
+}
+
+void PoseStream::finishSimulator(const QString &error)
+{
+    if (m_simulatorThread) {
+        m_simulatorThread->wait();
+        delete m_simulatorThread;
+        m_simulatorThread = nullptr;
+        emit simulatingChanged();
+    }
+
+    if (!error.isEmpty()) {
+        setStatus("Simulator error: " + error);
+        emit streamError(error);
+    }
+}
+
+void PoseStream::setStatus(const QString &status)
+{
+    if (m_status != status) {
+        m_status = status;
+        emit statusChanged();
+        qDebug() << "Pose stream status:" << status;
+    }
+}
@@ -0,0 +1,188 @@
+#ifndef POSESTREAM_H
+#define POSESTREAM_H
+
+#include <QObject>
+#include <QThread>
+#include <QPointer>
+#include <QMetaProperty>
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+#include <QQuaternion>
+#include <QVariant>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <atomic>
+#include "spscring.h"
+
+// One bone of a pose packet. Wire format, little-endian:
+//   header  quint32 magic "MPSE", quint16 version (1), quint16 boneCount, quint32 sequence
+//   bone    quint16 boneIndex (BoneManipulator.modelNodes index), quint8 flags, quint8 reserved,
+//           float position[3], float rotation[4] (quaternion x, y, z, w), float scale[3]
+// Without the Absolute flag, values are offsets from the rest pose like
+// BoneManipulator.boneTransforms; with it, they are local transforms.
+struct PoseSample
+{
+    enum Flags : quint8 {
+        HasPosition = 0x1,
+        HasRotation = 0x2,
+        HasScale = 0x4,
+        Absolute = 0x8
+    };
+
+    int bone = -1;
+    quint8 flags = 0;
+    QVector3D position;
+    QQuaternion rotation;
+    QVector3D scale;
+};
+
+struct PosePacket
+{
+    quint32 sequence = 0;
+    qint64 receivedAt = 0;      // PoseStream clock, ns
+    QVector<PoseSample> bones;
+};
+
+// Live pose input. A worker thread listens on a UDP port or a local socket
+// and parses packets straight into the slots of a lock-free ring; the GUI
+// thread calls applyLatest() once per frame, which drains the ring and
+// writes only the newest pose to the bone nodes. While recording, that pose
+// is also emitted as keyframe samples at a fixed rate.
+class PoseStream : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool listening READ listening NOTIFY listeningChanged)
+    Q_PROPERTY(QString transport READ transport WRITE setTransport NOTIFY transportChanged) // "udp" or "local"
+    Q_PROPERTY(int port READ port WRITE setPort NOTIFY portChanged)
+    Q_PROPERTY(QString serverName READ serverName WRITE setServerName NOTIFY serverNameChanged)
+    Q_PROPERTY(bool recording READ recording WRITE setRecording NOTIFY recordingChanged)
+    Q_PROPERTY(double recordRate READ recordRate WRITE setRecordRate NOTIFY recordRateChanged)
+    Q_PROPERTY(bool simulating READ simulating NOTIFY simulatingChanged)
+    Q_PROPERTY(int packetsReceived READ packetsReceived NOTIFY statsChanged)
+    Q_PROPERTY(int packetsDropped READ packetsDropped NOTIFY statsChanged)
+    Q_PROPERTY(double latency READ latency NOTIFY statsChanged) // ms from packet arrival to apply
+    Q_PROPERTY(QString status READ status NOTIFY statusChanged)
+
+public:
+    explicit PoseStream(QObject *parent = nullptr);
+    ~PoseStream();
+
+    // Properties
+    bool listening() const { return m_thread != nullptr; }
+    QString transport() const { return m_transport; }
+    int port() const { return m_port; }
+    QString serverName() const { return m_serverName; }
+    bool recording() const { return m_recording; }
+    double recordRate() const { return m_recordRate; }
+    bool simulating() const { return m_simulatorThread != nullptr; }
+    int packetsReceived() const { return m_packetsReceived.load(std::memory_order_relaxed); }
+    int packetsDropped() const { return m_packetsDropped.load(std::memory_order_relaxed); }
+    double latency() const { return m_latency; }
+    QString status() const { return m_status; }
+
+    void setTransport(const QString &transport);
+    void setPort(int port);
+    void setServerName(const QString &name);
+    void setRecording(bool recording);
+    void setRecordRate(double rate);
+
+    // nodes: BoneManipulator.modelNodes, restPose: BoneManipulator.originalTransforms
+    Q_INVOKABLE void setBones(const QVariantList &nodes, const QVariantMap &restPose);
+
+    // Call once per rendered frame. Returns true if a new pose was applied.
+    Q_INVOKABLE bool applyLatest();
+
+    // Streamed bones in BoneManipulator.boneTransforms format
+    Q_INVOKABLE QVariantMap currentTransforms() const;
+
+public slots:
+    void start();
+    void stop();
+
+    // Local stand-in for a mocap rig: sends a looping test pose to our own listener
+    void startSimulator(double rate = 120.0);
+    void stopSimulator();
+
+signals:
+    void listeningChanged();
+    void transportChanged();
+    void portChanged();
+    void serverNameChanged();
+    void recordingChanged();
+    void recordRateChanged();
+    void simulatingChanged();
+    void statsChanged();
+    void statusChanged();
+    void poseApplied();
+    void poseRecorded(int sample, const QVariantMap &transforms);
+    void streamError(const QString &message);
+
+private:
+    struct Target
+    {
+        QPointer<QObject> node;
+        QMetaProperty position;
+        QMetaProperty rotation;
+        QMetaProperty scale;
+        QVector3D restPosition;
+        QVector3D restRotation;
+        QVector3D restScale;
+    };
+
+    struct Offset
+    {
+        QVector3D position;
+        QVector3D rotation;
+        QVector3D scale = QVector3D(1, 1, 1);
+    };
+
+    // Per-sender ordering state, reset when the sender changes
+    struct SequenceState
+    {
+        quint32 last = 0;
+        bool valid = false;
+        int stale = 0;          // Older packets in a row since the last accepted one
+    };
+
+    void receiveUdp(int port);
+    void receiveLocal(const QString &serverName);
+    qsizetype pushPacket(const char *data, qsizetype size, SequenceState &sequence);
+    void runSimulator(const QVector<int> &bones, double rate, bool udp, int port, const QString &serverName);
+    void finishListening(const QString &error);
+    void finishSimulator(const QString &error);
+    void setStatus(const QString &status);
+
+    // Worker threads
+    QThread *m_thread;
+    std::atomic<bool> m_stopRequested;
+    QThread *m_simulatorThread;
+    std::atomic<bool> m_stopSimulator;
+
+    // Receiver -> GUI thread
+    SpscRing<PosePacket, 64> m_ring;
+    std::atomic<int> m_packetsReceived;
+    std::atomic<int> m_packetsDropped;
+    QElapsedTimer m_clock;
+
+    // GUI thread
+    PosePacket m_current;
+    bool m_hasPose;
+    QVector<Target> m_targets;          // Indexed by modelNodes index
+    QHash<int, Offset> m_offsets;       // Bone -> offset from the rest pose
+    double m_latency;
+
+    // Settings
+    QString m_transport;
+    int m_port;
+    QString m_serverName;
+    QString m_status;
+
+    // Recording
+    bool m_recording;
+    double m_recordRate;
+    qint64 m_recordStart;
+    int m_nextRecordSample;
+};
+
+#endif // POSESTREAM_H
@@ -0,0 +1,320 @@
+#include "yuvconverter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(YUV_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define YUV_HAVE_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define YUV_TARGET_AVX2
+#else
+#define YUV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// BT.601 limited range, 8-bit fixed point (same coefficients as swscale's default)
+inline uchar rgbToY(int r, int g, int b)
+{
+    return uchar(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uchar rgbToU(int r, int g, int b)
+{
+    return uchar(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uchar rgbToV(int r, int g, int b)
+{
+    return uchar(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+// Reference path: converts columns [x0, width) of one row pair.
+// row1 may be null for the last row of an odd-height image.
+void convertRowPairScalar(const uchar *row0, const uchar *row1, int width, int x0,
+                          uchar *y0, uchar *y1, uchar *u, uchar *v)
+{
+    for (int x = x0; x < width; x += 2) {
+        int sumR = 0, sumG = 0, sumB = 0, count = 0;
+
+        for (int dx = 0; dx < 2 && x + dx < width; ++dx) {
+            const uchar *p = row0 + (x + dx) * 4;
+            y0[x + dx] = rgbToY(p[0], p[1], p[2]);
+            sumR += p[0]; sumG += p[1]; sumB += p[2]; ++count;
+
+            if (row1) {
+                const uchar *q = row1 + (x + dx) * 4;
+                y1[x + dx] = rgbToY(q[0], q[1], q[2]);
+                sumR += q[0]; sumG += q[1]; sumB += q[2]; ++count;
+            }
+        }
+
+        const int r = (sumR + count / 2) / count;
+        const int g = (sumG + count / 2) / count;
+        const int b = (sumB + count / 2) / count;
+        u[x / 2] = rgbToU(r, g, b);
+        v[x / 2] = rgbToV(r, g, b);
+    }
+}
+
+#ifdef YUV_HAVE_SSE2
+
+// 8 RGBA pixels -> R, G, B as 8 x int16
+inline void deinterleaveSse2(const uchar *p, __m128i &r, __m128i &g, __m128i &b)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+
+    r = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(c, mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), mask),
+                        _mm_and_si128(_mm_srli_epi32(c, 8), mask));
+    b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), mask),
+                        _mm_and_si128(_mm_srli_epi32(c, 16), mask));
+}
+
+// The Y sum peaks at 56228, so it is computed with wrapping 16-bit adds and a logical shift
+inline __m128i lumaSse2(__m128i r, __m128i g, __m128i b)
+{
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                              _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+    t = _mm_add_epi16(t, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+    t = _mm_add_epi16(t, _mm_set1_epi16(128));
+    return _mm_add_epi16(_mm_srli_epi16(t, 8), _mm_set1_epi16(16));
+}
+
+inline __m128i chromaSse2(__m128i r, __m128i g, __m128i b, short cr, short cg, short cb)
+{
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(cr)),
+                              _mm_mullo_epi16(g, _mm_set1_epi16(cg)));
+    t = _mm_add_epi16(t, _mm_mullo_epi16(b, _mm_set1_epi16(cb)));
+    t = _mm_add_epi16(t, _mm_set1_epi16(128));
+    return _mm_add_epi16(_mm_srai_epi16(t, 8), _mm_set1_epi16(128));
+}
+
+// Sums horizontally adjacent pairs: two 8 x int16 vectors -> 8 x int16
+inline __m128i pairSumSse2(__m128i lo, __m128i hi)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    return _mm_packs_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, ones));
+}
+
+// Converts 16 pixels of a row pair per iteration, returns the number of columns done
+int convertRowPairSse2(const uchar *row0, const uchar *row1, int width,
+                       uchar *y0, uchar *y1, uchar *u, uchar *v)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i r0a, g0a, b0a, r0b, g0b, b0b;
+        __m128i r1a, g1a, b1a, r1b, g1b, b1b;
+        deinterleaveSse2(row0 + x * 4, r0a, g0a, b0a);
+        deinterleaveSse2(row0 + x * 4 + 32, r0b, g0b, b0b);
+        deinterleaveSse2(row1 + x * 4, r1a, g1a, b1a);
+        deinterleaveSse2(row1 + x * 4 + 32, r1b, g1b, b1b);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y0 + x),
+                         _mm_packus_epi16(lumaSse2(r0a, g0a, b0a), lumaSse2(r0b, g0b, b0b)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y1 + x),
+                         _mm_packus_epi16(lumaSse2(r1a, g1a, b1a), lumaSse2(r1b, g1b, b1b)));
+
+        const __m128i two = _mm_set1_epi16(2);
+        const __m128i r = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(pairSumSse2(r0a, r0b), pairSumSse2(r1a, r1b)), two), 2);
+        const __m128i g = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(pairSumSse2(g0a, g0b), pairSumSse2(g1a, g1b)), two), 2);
+        const __m128i b = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(pairSumSse2(b0a, b0b), pairSumSse2(b1a, b1b)), two), 2);
+
+        const __m128i cu = chromaSse2(r, g, b, -38, -74, 112);
+        const __m128i cv = chromaSse2(r, g, b, 112, -94, -18);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x / 2), _mm_packus_epi16(cu, cu));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x / 2), _mm_packus_epi16(cv, cv));
+    }
+    return x;
+}
+
+#endif // YUV_HAVE_SSE2
+
+#ifdef YUV_HAVE_AVX2
+
+// 16 RGBA pixels -> R, G, B as 16 x int16. packs works per 128-bit lane, so the
+// pixel order is 0-3, 8-11 | 4-7, 12-15; horizontally adjacent pixels stay adjacent.
+YUV_TARGET_AVX2 inline void deinterleaveAvx2(const uchar *p, __m256i &r, __m256i &g, __m256i &b)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+
+    r = _mm256_packs_epi32(_mm256_and_si256(a, mask), _mm256_and_si256(c, mask));
+    g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 8), mask),
+                           _mm256_and_si256(_mm256_srli_epi32(c, 8), mask));
+    b = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 16), mask),
+                           _mm256_and_si256(_mm256_srli_epi32(c, 16), mask));
+}
+
+YUV_TARGET_AVX2 inline __m256i lumaAvx2(__m256i r, __m256i g, __m256i b)
+{
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(66)),
+                                 _mm256_mullo_epi16(g, _mm256_set1_epi16(129)));
+    t = _mm256_add_epi16(t, _mm256_mullo_epi16(b, _mm256_set1_epi16(25)));
+    t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srli_epi16(t, 8), _mm256_set1_epi16(16));
+}
+
+YUV_TARGET_AVX2 inline __m256i chromaAvx2(__m256i r, __m256i g, __m256i b, short cr, short cg, short cb)
+{
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(cr)),
+                                 _mm256_mullo_epi16(g, _mm256_set1_epi16(cg)));
+    t = _mm256_add_epi16(t, _mm256_mullo_epi16(b, _mm256_set1_epi16(cb)));
+    t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srai_epi16(t, 8), _mm256_set1_epi16(128));
+}
+
+YUV_TARGET_AVX2 inline __m256i pairSumAvx2(__m256i lo, __m256i hi)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    return _mm256_packs_epi32(_mm256_madd_epi16(lo, ones), _mm256_madd_epi16(hi, ones));
+}
+
+// Converts 32 pixels of a row pair per iteration, returns the number of columns done
+YUV_TARGET_AVX2 int convertRowPairAvx2(const uchar *row0, const uchar *row1, int width,
+                                       uchar *y0, uchar *y1, uchar *u, uchar *v)
+{
+    // Undo the per-lane interleaving of packs/packus
+    const __m256i lumaOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i chromaOrder = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                                 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    const __m256i two = _mm256_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i r0a, g0a, b0a, r0b, g0b, b0b;
+        __m256i r1a, g1a, b1a, r1b, g1b, b1b;
+        deinterleaveAvx2(row0 + x * 4, r0a, g0a, b0a);
+        deinterleaveAvx2(row0 + x * 4 + 64, r0b, g0b, b0b);
+        deinterleaveAvx2(row1 + x * 4, r1a, g1a, b1a);
+        deinterleaveAvx2(row1 + x * 4 + 64, r1b, g1b, b1b);
+
+        const __m256i luma0 = _mm256_packus_epi16(lumaAvx2(r0a, g0a, b0a), lumaAvx2(r0b, g0b, b0b));
+        const __m256i luma1 = _mm256_packus_epi16(lumaAvx2(r1a, g1a, b1a), lumaAvx2(r1b, g1b, b1b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(y0 + x), _mm256_permutevar8x32_epi32(luma0, lumaOrder));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(y1 + x), _mm256_permutevar8x32_epi32(luma1, lumaOrder));
+
+        const __m256i r = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(pairSumAvx2(r0a, r0b), pairSumAvx2(r1a, r1b)), two), 2);
+        const __m256i g = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(pairSumAvx2(g0a, g0b), pairSumAvx2(g1a, g1b)), two), 2);
+        const __m256i b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(pairSumAvx2(b0a, b0b), pairSumAvx2(b1a, b1b)), two), 2);
+
+        // [U lane0 | V lane0 | U lane1 | V lane1] -> [U | V], then restore column order
+        __m256i uv = _mm256_packus_epi16(chromaAvx2(r, g, b, -38, -74, 112),
+                                         chromaAvx2(r, g, b, 112, -94, -18));
+        uv = _mm256_permute4x64_epi64(uv, _MM_SHUFFLE(3, 1, 2, 0));
+        uv = _mm256_shuffle_epi8(uv, chromaOrder);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(u + x / 2), _mm256_castsi256_si128(uv));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(v + x / 2), _mm256_extracti128_si256(uv, 1));
+    }
+    return x;
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+        return false;
+    // The OS must save the YMM state
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // YUV_HAVE_AVX2
+
+} // namespace
+
+qsizetype YuvConverter::frameSize(int width, int height)
+{
+    const qsizetype chromaWidth = (width + 1) / 2;
+    const qsizetype chromaHeight = (height + 1) / 2;
+    return qsizetype(width) * height + 2 * chromaWidth * chromaHeight;
+}
+
+void YuvConverter::rgbaToYuv420(const uchar *rgba, int width, int height, qsizetype stride, uchar *dst)
+{
+    static const Kernel kernel = bestKernel();
+    rgbaToYuv420(rgba, width, height, stride, dst, kernel);
+}
+
+void YuvConverter::rgbaToYuv420(const uchar *rgba, int width, int height, qsizetype stride, uchar *dst, Kernel kernel)
+{
+    if (!rgba || !dst || width <= 0 || height <= 0)
+        return;
+
+    const int chromaWidth = (width + 1) / 2;
+    uchar *planeY = dst;
+    uchar *planeU = planeY + qsizetype(width) * height;
+    uchar *planeV = planeU + qsizetype(chromaWidth) * ((height + 1) / 2);
+
+    for (int row = 0; row < height; row += 2) {
+        const uchar *row0 = rgba + row * stride;
+        const uchar *row1 = row + 1 < height ? row0 + stride : nullptr;
+        uchar *y0 = planeY + qsizetype(row) * width;
+        uchar *y1 = row1 ? y0 + width : nullptr;
+        uchar *u = planeU + qsizetype(row / 2) * chromaWidth;
+        uchar *v = planeV + qsizetype(row / 2) * chromaWidth;
+
+        int done = 0;
+        if (row1) {
+            switch (kernel) {
+#ifdef YUV_HAVE_AVX2
+            case AVX2:
+                done = convertRowPairAvx2(row0, row1, width, y0, y1, u, v);
+                break;
+#endif
+#ifdef YUV_HAVE_SSE2
+            case SSE2:
+                done = convertRowPairSse2(row0, row1, width, y0, y1, u, v);
+                break;
+#endif
+            default:
+                break;
+            }
+        }
+
+        convertRowPairScalar(row0, row1, width, done, y0, y1, u, v);
+    }
+}
+
+YuvConverter::Kernel YuvConverter::bestKernel()
+{
+#ifdef YUV_HAVE_AVX2
+    if (cpuHasAvx2())
+        return AVX2;
+#endif
+#ifdef YUV_HAVE_SSE2
+    return SSE2;
+#else
+    return Scalar;
+#endif
+}
+
+const char *YuvConverter::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case AVX2:
+        return "AVX2";
+    case SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
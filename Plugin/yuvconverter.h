@@ -0,0 +1,31 @@
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <QtGlobal>
+
+// Conversion of captured RGBA frames to planar YUV 4:2:0 (BT.601, limited range),
+// the layout FFmpeg expects for "-f rawvideo -pix_fmt yuv420p" input.
+// SSE2/AVX2 kernels are selected at runtime; the scalar path is the reference
+// implementation and handles odd widths/heights and row tails.
+class YuvConverter
+{
+public:
+    enum Kernel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Size in bytes of one planar YUV420 frame (Y + U + V)
+    static qsizetype frameSize(int width, int height);
+
+    // rgba: R,G,B,A byte order (QImage::Format_RGBA8888 / RGBX8888)
+    // dst:  buffer of at least frameSize(width, height) bytes
+    static void rgbaToYuv420(const uchar *rgba, int width, int height, qsizetype stride, uchar *dst);
+    static void rgbaToYuv420(const uchar *rgba, int width, int height, qsizetype stride, uchar *dst, Kernel kernel);
+
+    static Kernel bestKernel();
+    static const char *kernelName(Kernel kernel);
+};
+
+#endif // YUVCONVERTER_H
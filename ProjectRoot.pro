@@ -2,5 +2,6 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     ConsoleApp \
-    Plugin
+    Plugin \
+    tests
 INCLUDEPATH += common/
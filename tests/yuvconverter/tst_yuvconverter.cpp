@@ -0,0 +1,255 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include "yuvconverter.h"
+
+// The SSE2/AVX2 kernels must produce exactly the bytes of the scalar path
+class TestYuvConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frameSize();
+    void scalarReferenceColors_data();
+    void scalarReferenceColors();
+    void kernelMatchesScalar_data();
+    void kernelMatchesScalar();
+    void kernelExtremeValues_data();
+    void kernelExtremeValues();
+
+private:
+    enum Pattern {
+        Random,
+        Black,
+        White,
+        Checker,        // Black/white pixels, chroma averages hit the rounding edge
+        RandomExtremes  // Every channel 0 or 255
+    };
+
+    static void addKernelRows(const QList<int> &widths, const QList<int> &heights);
+    static bool skipUnsupported(YuvConverter::Kernel kernel);
+    static QByteArray makeImage(int width, int height, qsizetype stride, Pattern pattern);
+    static QByteArray convert(const QByteArray &image, int width, int height, qsizetype stride,
+                              YuvConverter::Kernel kernel);
+    static QString firstMismatch(const QByteArray &actual, const QByteArray &expected, int width, int height);
+};
+
+// Guard bytes after the frame catch writes past frameSize()
+constexpr int GuardSize = 64;
+constexpr char GuardByte = char(0xA5);
+
+void TestYuvConverter::frameSize()
+{
+    QCOMPARE(YuvConverter::frameSize(2, 2), qsizetype(6));
+    QCOMPARE(YuvConverter::frameSize(1, 1), qsizetype(3));
+    QCOMPARE(YuvConverter::frameSize(3, 3), qsizetype(9 + 2 * 4));
+    QCOMPARE(YuvConverter::frameSize(1920, 1080), qsizetype(1920 * 1080 * 3 / 2));
+}
+
+void TestYuvConverter::scalarReferenceColors_data()
+{
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("g");
+    QTest::addColumn<int>("b");
+    QTest::addColumn<int>("y");
+    QTest::addColumn<int>("u");
+    QTest::addColumn<int>("v");
+
+    // BT.601 limited range, 8-bit fixed point as in swscale
+    QTest::newRow("black") << 0 << 0 << 0 << 16 << 128 << 128;
+    QTest::newRow("white") << 255 << 255 << 255 << 235 << 128 << 128;
+    QTest::newRow("red") << 255 << 0 << 0 << 82 << 90 << 240;
+    QTest::newRow("green") << 0 << 255 << 0 << 144 << 54 << 34;
+    QTest::newRow("blue") << 0 << 0 << 255 << 41 << 240 << 110;
+}
+
+void TestYuvConverter::scalarReferenceColors()
+{
+    QFETCH(int, r);
+    QFETCH(int, g);
+    QFETCH(int, b);
+    QFETCH(int, y);
+    QFETCH(int, u);
+    QFETCH(int, v);
+
+    // Odd size, so the scalar path also covers the partial chroma block
+    const int width = 5;
+    const int height = 3;
+    QByteArray image(width * height * 4, char(255));
+    for (int i = 0; i < width * height; ++i) {
+        image[i * 4] = char(r);
+        image[i * 4 + 1] = char(g);
+        image[i * 4 + 2] = char(b);
+    }
+
+    const QByteArray yuv = convert(image, width, height, width * 4, YuvConverter::Scalar);
+    const uchar *planeY = reinterpret_cast<const uchar *>(yuv.constData());
+    const uchar *planeU = planeY + width * height;
+    const uchar *planeV = planeU + 3 * 2;
+
+    for (int i = 0; i < width * height; ++i) {
+        QCOMPARE(int(planeY[i]), y);
+    }
+    for (int i = 0; i < 3 * 2; ++i) {
+        QCOMPARE(int(planeU[i]), u);
+        QCOMPARE(int(planeV[i]), v);
+    }
+}
+
+void TestYuvConverter::kernelMatchesScalar_data()
+{
+    // Around the 16 (SSE2) and 32 (AVX2) column blocks, odd and even, plus a real frame size
+    addKernelRows({ 1, 2, 15, 16, 17, 31, 32, 33, 47, 64, 65, 100, 641 },
+                  { 1, 2, 3, 4, 7, 33, 361 });
+}
+
+void TestYuvConverter::kernelMatchesScalar()
+{
+    QFETCH(int, kernel);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, padding);
+
+    if (skipUnsupported(YuvConverter::Kernel(kernel))) {
+        QSKIP("Kernel is not available on this CPU or compiler");
+    }
+
+    const qsizetype stride = qsizetype(width) * 4 + padding;
+    const QByteArray image = makeImage(width, height, stride, Random);
+    const QByteArray expected = convert(image, width, height, stride, YuvConverter::Scalar);
+    const QByteArray actual = convert(image, width, height, stride, YuvConverter::Kernel(kernel));
+
+    const QString mismatch = firstMismatch(actual, expected, width, height);
+    QVERIFY2(mismatch.isEmpty(), qPrintable(mismatch));
+}
+
+void TestYuvConverter::kernelExtremeValues_data()
+{
+    addKernelRows({ 16, 33, 64, 65 }, { 2, 5 });
+}
+
+void TestYuvConverter::kernelExtremeValues()
+{
+    QFETCH(int, kernel);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, padding);
+
+    if (skipUnsupported(YuvConverter::Kernel(kernel))) {
+        QSKIP("Kernel is not available on this CPU or compiler");
+    }
+
+    const qsizetype stride = qsizetype(width) * 4 + padding;
+    for (Pattern pattern : { Black, White, Checker, RandomExtremes }) {
+        const QByteArray image = makeImage(width, height, stride, pattern);
+        const QByteArray expected = convert(image, width, height, stride, YuvConverter::Scalar);
+        const QByteArray actual = convert(image, width, height, stride, YuvConverter::Kernel(kernel));
+
+        const QString mismatch = firstMismatch(actual, expected, width, height);
+        QVERIFY2(mismatch.isEmpty(), qPrintable(QString("pattern %1: %2").arg(int(pattern)).arg(mismatch)));
+    }
+}
+
+void TestYuvConverter::addKernelRows(const QList<int> &widths, const QList<int> &heights)
+{
+    QTest::addColumn<int>("kernel");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("padding");
+
+    for (YuvConverter::Kernel kernel : { YuvConverter::SSE2, YuvConverter::AVX2 }) {
+        for (int width : widths) {
+            for (int height : heights) {
+                // Tightly packed, one extra pixel, and an unaligned byte count
+                for (int padding : { 0, 4, 13 }) {
+                    QTest::addRow("%s %dx%d +%d", YuvConverter::kernelName(kernel), width, height, padding)
+                        << int(kernel) << width << height << padding;
+                }
+            }
+        }
+    }
+}
+
+bool TestYuvConverter::skipUnsupported(YuvConverter::Kernel kernel)
+{
+    const YuvConverter::Kernel best = YuvConverter::bestKernel();
+    return best == YuvConverter::Scalar || (kernel == YuvConverter::AVX2 && best != YuvConverter::AVX2);
+}
+
+QByteArray TestYuvConverter::makeImage(int width, int height, qsizetype stride, Pattern pattern)
+{
+    // Padding gets its own noise: a kernel reading it would change the result
+    QRandomGenerator random(quint32(width * 7919 + height * 104729 + int(pattern)));
+    QByteArray image(stride * height, Qt::Uninitialized);
+    for (qsizetype i = 0; i < image.size(); ++i) {
+        image[i] = char(random.bounded(256));
+    }
+
+    for (int row = 0; row < height; ++row) {
+        uchar *line = reinterpret_cast<uchar *>(image.data()) + row * stride;
+        for (int x = 0; x < width; ++x) {
+            uchar *p = line + x * 4;
+            for (int channel = 0; channel < 3; ++channel) {
+                switch (pattern) {
+                case Random:
+                    break;
+                case Black:
+                    p[channel] = 0;
+                    break;
+                case White:
+                    p[channel] = 255;
+                    break;
+                case Checker:
+                    p[channel] = (x + row) % 2 ? 255 : 0;
+                    break;
+                case RandomExtremes:
+                    p[channel] = random.bounded(2) ? 255 : 0;
+                    break;
+                }
+            }
+        }
+    }
+    return image;
+}
+
+QByteArray TestYuvConverter::convert(const QByteArray &image, int width, int height, qsizetype stride,
+                                     YuvConverter::Kernel kernel)
+{
+    const qsizetype size = YuvConverter::frameSize(width, height);
+    QByteArray yuv(size + GuardSize, GuardByte);
+    YuvConverter::rgbaToYuv420(reinterpret_cast<const uchar *>(image.constData()), width, height, stride,
+                               reinterpret_cast<uchar *>(yuv.data()), kernel);
+    return yuv;
+}
+
+QString TestYuvConverter::firstMismatch(const QByteArray &actual, const QByteArray &expected, int width, int height)
+{
+    const qsizetype size = YuvConverter::frameSize(width, height);
+    for (qsizetype i = size; i < actual.size(); ++i) {
+        if (actual[i] != GuardByte) {
+            return QString("wrote past the frame at byte %1").arg(i - size);
+        }
+    }
+
+    const qsizetype lumaSize = qsizetype(width) * height;
+    const qsizetype chromaSize = qsizetype((width + 1) / 2) * ((height + 1) / 2);
+    for (qsizetype i = 0; i < size; ++i) {
+        if (actual[i] == expected[i]) continue;
+
+        QString plane = "Y";
+        qsizetype offset = i;
+        int planeWidth = width;
+        if (i >= lumaSize) {
+            offset = (i - lumaSize) % chromaSize;
+            plane = i < lumaSize + chromaSize ? "U" : "V";
+            planeWidth = (width + 1) / 2;
+        }
+        return QString("%1 plane (%2, %3): %4, scalar %5")
+            .arg(plane).arg(offset % planeWidth).arg(offset / planeWidth)
+            .arg(uchar(actual[i])).arg(uchar(expected[i]));
+    }
+    return QString();
+}
+
+QTEST_APPLESS_MAIN(TestYuvConverter)
+
+#include "tst_yuvconverter.moc"
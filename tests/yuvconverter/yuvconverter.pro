@@ -0,0 +1,19 @@
+QT += testlib
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+TARGET = tst_yuvconverter
+
+SOURCES += \
+    tst_yuvconverter.cpp \
+    ../../Plugin/yuvconverter.cpp
+
+HEADERS += \
+    ../../Plugin/yuvconverter.h
+
+INCLUDEPATH += ../../Plugin